@@ -1,11 +1,26 @@
+#include "executer/chunked_task.h"
+#include "executer/executer.h"
+#include "mapped_file/mapped_file.h"
+#include "multipartite_graphs/acyclic_orintations.h"
 #include "multipartite_graphs/multipartite_graphs.h"
 #include "optparser/optparser.h"
+#include "query_format/query_format.h"
+#include "singleton/singleton.h"
+#include "socket_server/unix_socket_server.h"
 
+#include <algorithm>
+#include <array>
 #include <iostream>
+#include <map>
+#include <thread>
 #include <vector>
 #include <charconv>
+#include <chrono>
+#include <csignal>
 #include <memory>
 #include <fstream>
+#include <iterator>
+#include <string_view>
 #include <exception>
 
 
@@ -62,17 +77,19 @@ class TStopProcessException : public std::exception {
 };
 
 
-bool RunOne(IDataAsker& asker, IDataWriter& writer) {
+struct TQuery {
+    NMultipartiteGraphs::TCompleteGraph Graph;
+    NMultipartiteGraphs::TEdgeSet Edges;
+};
+
+bool AskQuery(IDataAsker& asker, TQuery& query) {
     try {
-        NMultipartiteGraphs::TCompleteGraph completeGraph = asker.AskCompleteGraph();
+        query.Graph = asker.AskCompleteGraph();
         unsigned edgeCount = asker.AskEdgeCount();
-        NMultipartiteGraphs::TEdgeSet edges;
+        query.Edges.clear();
         for (unsigned edgeNum = 0; edgeNum != edgeCount; ++edgeNum) {
-            edges.emplace(asker.AskEdge());
+            query.Edges.emplace(asker.AskEdge());
         }
-
-        NMultipartiteGraphs::TDenseGraph denseGraph(completeGraph, std::move(edges));
-        writer.WriteAnswer(denseGraph, denseGraph.CountAcyclicOrientations());
     } catch (const TStopProcessException&) {
         return false;
     }
@@ -80,11 +97,98 @@ bool RunOne(IDataAsker& asker, IDataWriter& writer) {
     return true;
 }
 
+bool RunOne(IDataAsker& asker, IDataWriter& writer) {
+    TQuery query;
+    if (!AskQuery(asker, query)) {
+        return false;
+    }
+
+    NMultipartiteGraphs::TDenseGraph denseGraph(query.Graph, std::move(query.Edges));
+    writer.WriteAnswer(denseGraph, denseGraph.CountAcyclicOrientations());
+    return true;
+}
+
+/*
+ * Key of a query which does not depend on the order of deleted edges
+ * and on the order of the ends of an edge.
+ */
+std::vector<long long> QueryKey(const TQuery& query) {
+    using TEnds = std::array<long long, 4>;
+
+    std::vector<TEnds> edges;
+    for (const auto& edge : query.Edges) {
+        TEnds ends{static_cast<long long>(edge.First.ComponentId), edge.First.VertexId, static_cast<long long>(edge.Second.ComponentId), edge.Second.VertexId};
+        if (std::make_pair(ends[2], ends[3]) < std::make_pair(ends[0], ends[1])) {
+            std::swap(ends[0], ends[2]);
+            std::swap(ends[1], ends[3]);
+        }
+        edges.push_back(ends);
+    }
+
+    std::sort(edges.begin(), edges.end());
+    std::vector<long long> key(query.Graph.begin(), query.Graph.end());
+    key.push_back(-1);
+    for (const auto& ends : edges) {
+        key.insert(key.end(), ends.begin(), ends.end());
+    }
+
+    return key;
+}
+
+/*
+ * Reads every query, evaluates distinct ones on the executer
+ * and writes the answers in the input order.
+ * Repeated queries are computed once, the complete graph memo
+ * of the deletion-contraction is shared by all workers.
+ */
+void RunBatch(IDataAsker& asker, const IDataWriter& writer, const TExecuterOptions& executerOptions, size_t chunkSize) {
+    std::vector<TQuery> queries;
+    // for every query the index of its answer
+    std::vector<size_t> answerIndices;
+    // for every answer the first query which needs it
+    std::vector<size_t> distinctQueries;
+    std::map<std::vector<long long>, size_t> seen;
+
+    TQuery query;
+    while (AskQuery(asker, query)) {
+        auto [iter, inserted] = seen.emplace(QueryKey(query), distinctQueries.size());
+        if (inserted) {
+            distinctQueries.push_back(queries.size());
+        }
+
+        answerIndices.push_back(iter->second);
+        queries.push_back(std::move(query));
+    }
+
+    std::vector<long long> answers(distinctQueries.size());
+    auto executer = CreateExecuter(executerOptions);
+    {
+        auto evaluate = [&queries, &distinctQueries, &answers](size_t index) {
+            const auto& current = queries[distinctQueries[index]];
+            NMultipartiteGraphs::TDenseGraph denseGraph(current.Graph, current.Edges);
+            answers[index] = denseGraph.CountAcyclicOrientations();
+        };
+
+        TChunkedSubmitter<size_t, decltype(evaluate)> submitter(*executer, evaluate, chunkSize);
+        for (size_t index = 0; index != distinctQueries.size(); ++index) {
+            submitter.Add(size_t{index});
+        }
+    }
+    executer->Stop();
+
+    for (size_t index = 0; index != queries.size(); ++index) {
+        NMultipartiteGraphs::TDenseGraph denseGraph(queries[index].Graph, queries[index].Edges);
+        writer.WriteAnswer(denseGraph, answers[answerIndices[index]]);
+    }
+}
+
 
 std::string GetNonEmptyLine(std::istream& input) {
     std::string line;
     while (line.empty()) {
-        std::getline(input, line);
+        if (!std::getline(input, line)) {
+            throw TStopProcessException();
+        }
     }
 
     return line;
@@ -119,7 +223,10 @@ public:
         }
 
         unsigned answer;
-        Input >> answer;
+        if (!(Input >> answer)) {
+            throw TStopProcessException();
+        }
+
         return answer;
     }
 
@@ -155,6 +262,53 @@ private:
     bool Verbose;
 };
 
+/*
+ * Asks queries from a query file which is tokenized in place,
+ * see NQueryFormat for the text and binary formats.
+ */
+class TQueryAsker : public IDataAsker {
+public:
+    explicit TQueryAsker(std::string_view data)
+        : Reader(data)
+    {
+    }
+
+    NMultipartiteGraphs::TCompleteGraph AskCompleteGraph() override {
+        if (!Reader.Next(Current)) {
+            throw TStopProcessException();
+        }
+
+        NextEdge = 0;
+        return NMultipartiteGraphs::TCompleteGraph(Current.Components);
+    }
+
+    unsigned AskEdgeCount() override {
+        return static_cast<unsigned>(Current.Edges.size());
+    }
+
+    NMultipartiteGraphs::TEdge AskEdge() override {
+        return Current.Edges[NextEdge++];
+    }
+
+private:
+    NQueryFormat::TQueryReader Reader;
+    NQueryFormat::TQuery Current;
+    size_t NextEdge = 0;
+};
+
+void ConvertToBinary(std::string_view data, std::ostream& output) {
+    NQueryFormat::TQueryReader reader(data);
+    NQueryFormat::TQuery query;
+    TOutputBuffer buffer;
+    NQueryFormat::WriteHeader(buffer);
+    while (reader.Next(query)) {
+        NQueryFormat::WriteQuery(buffer, query);
+    }
+
+    auto block = buffer.Take();
+    output.write(block.data(), block.size());
+}
+
 class TFullWriter : public IDataWriter {
 public:
     TFullWriter(std::ostream& output)
@@ -201,29 +355,134 @@ private:
 };
 
 
+void PrintMemoStats(std::ostream& out, const TCacheStats& stats) {
+    out << "memo size: " << stats.Size << ", capacity: " << stats.Capacity
+        << ", hits: " << stats.Hits << ", misses: " << stats.Misses << ", evictions: " << stats.Evictions << std::endl;
+}
+
+TUnixSocketServer* ServerToStop = nullptr;
+
+void StopServer(int) {
+    if (ServerToStop != nullptr) {
+        ServerToStop->Stop();
+    }
+}
+
+/*
+ * Answers queries of the line protocol on a Unix socket, one answer per line.
+ * The process stays alive, so the acyclic orientations memo
+ * and the binomial table stay warm across requests.
+ * Clients idle for idleTimeoutMs are disconnected, so they do not hold the workers.
+ * Stops on SIGINT or SIGTERM, open connections are closed.
+ */
+void RunServer(const std::string& path, const TExecuterOptions& executerOptions, size_t idleTimeoutMs) {
+    auto executer = CreateExecuter(executerOptions);
+    TUnixSocketServer::THandler handler = [](std::istream& in, std::ostream& out) {
+        TStreamAsker asker(in, out, false);
+        TSimpleWriter writer(out);
+        while (RunOne(asker, writer)) {
+        }
+    };
+
+    TUnixSocketServer server(path, 64, std::chrono::milliseconds(idleTimeoutMs));
+    ServerToStop = &server;
+    std::signal(SIGINT, StopServer);
+    std::signal(SIGTERM, StopServer);
+    std::cerr << "listening on " << path << std::endl;
+    server.Serve(*executer, handler);
+    executer->Stop();
+    ServerToStop = nullptr;
+}
+
+
 int main(int argc, const char ** argv) {
     std::string inputFile = "";
     std::string outputFile = "";
+    bool batch = false;
+    bool toBinary = false;
+    std::string listen = "";
+    size_t idleTimeoutMs = 0;
+    std::string acyclicCache = "";
+    size_t memoBudgetMb = 0;
+    bool memoStats = false;
+    int threadCount = 0;
+    size_t chunkSize = 0;
 
     TParser optParser;
     optParser.AddLongOption('i', "input-file").Store(&inputFile);
     optParser.AddLongOption('o', "output-file").Store(&outputFile);
+    optParser.AddLongOption("batch").SetFlag(&batch).Default("false");
+    optParser.AddLongOption("thread-count").Store(&threadCount).Default("0");
+    optParser.AddLongOption("chunk-size").Store(&chunkSize).Default("16");
+    optParser.AddLongOption("to-binary").SetFlag(&toBinary).Default("false");
+    optParser.AddLongOption("listen").Store(&listen).Default("");
+    optParser.AddLongOption("idle-timeout-ms").Store(&idleTimeoutMs).Default("60000");
+    optParser.AddLongOption("acyclic-cache").Store(&acyclicCache).Default("");
+    optParser.AddLongOption("memo-budget-mb").Store(&memoBudgetMb).Default("0");
+    optParser.AddLongOption("memo-stats").SetFlag(&memoStats).Default("false");
     optParser.Parse(argc, argv);
 
+    auto& counter = TSingleton<NMultipartiteGraphs::TCompleteGraphAcyclicOrientationsCounter>::Instance();
+    counter.SetMemoBudget(memoBudgetMb << 20);
+    if (!acyclicCache.empty()) {
+        counter.AttachTable(acyclicCache);
+    }
+
+    TExecuterOptions executerOptions;
+    executerOptions.ThreadCount = threadCount > 0 ? threadCount : std::max(1u, std::thread::hardware_concurrency());
+    executerOptions.MaxQueueSize = 1000;
+
+    if (!listen.empty()) {
+        RunServer(listen, executerOptions, idleTimeoutMs);
+        counter.SaveTable();
+        if (memoStats) {
+            PrintMemoStats(std::cerr, counter.MemoStats());
+        }
+        return 0;
+    }
+
+    // a regular input file is mapped and tokenized in place, pipes are read as streams
+    std::unique_ptr<TMappedFile> inputFileMapping{nullptr};
     std::unique_ptr<std::ifstream> inputFileStream{nullptr};
     if (!inputFile.empty()) {
-        inputFileStream.reset(new std::ifstream(inputFile));
+        if (TMappedFile::CanMap(inputFile)) {
+            inputFileMapping.reset(new TMappedFile(inputFile));
+        } else {
+            inputFileStream.reset(new std::ifstream(inputFile, std::ios::in | std::ios::binary));
+            if (!*inputFileStream) {
+                std::cerr << "can not open " << inputFile << std::endl;
+                return 1;
+            }
+        }
     }
 
+    std::istream& inputStream = (inputFileStream.get() == nullptr) ? std::cin : *inputFileStream;
+
     std::unique_ptr<std::ofstream> outputFileStream{nullptr};
     if (!outputFile.empty()) {
-        outputFileStream.reset(new std::ofstream(outputFile));
+        outputFileStream.reset(new std::ofstream(outputFile, std::ios::out | std::ios::binary));
     }
 
-    std::istream& inputStream = (inputFileStream.get() == nullptr) ? std::cin : *inputFileStream;
     std::ostream& outputStream = (outputFileStream.get() == nullptr) ? std::cout : *outputFileStream;
 
-    std::unique_ptr<TStreamAsker> asker = std::make_unique<TStreamAsker>(inputStream, outputStream, outputFileStream.get() == nullptr);
+    if (toBinary) {
+        std::string input;
+        if (!inputFileMapping) {
+            input.assign(std::istreambuf_iterator<char>(inputStream), std::istreambuf_iterator<char>());
+        }
+
+        ConvertToBinary(inputFileMapping ? inputFileMapping->View() : std::string_view(input), outputStream);
+        return 0;
+    }
+
+    std::unique_ptr<IDataAsker> asker;
+    if (inputFileMapping) {
+        asker = std::make_unique<TQueryAsker>(inputFileMapping->View());
+    } else {
+        bool verbose = (inputFileStream.get() == nullptr) && (outputFileStream.get() == nullptr);
+        asker = std::make_unique<TStreamAsker>(inputStream, outputStream, verbose);
+    }
+
     std::unique_ptr<IDataWriter> writer;
     if (outputFile.empty()) {
         writer = std::make_unique<TSimpleWriter>(outputStream);
@@ -231,16 +490,20 @@ int main(int argc, const char ** argv) {
         writer = std::make_unique<TFullWriter>(outputStream);
     }
 
-    while (RunOne(*asker, *writer)) {
-    }
-
-    if (inputFileStream.get() != nullptr) {
-        inputFileStream->close();
+    if (batch) {
+        RunBatch(*asker, *writer, executerOptions, chunkSize);
+    } else {
+        while (RunOne(*asker, *writer)) {
+        }
     }
 
     if (outputFileStream.get() != nullptr) {
         outputFileStream->close();
     }
 
+    counter.SaveTable();
+    if (memoStats) {
+        PrintMemoStats(std::cerr, counter.MemoStats());
+    }
     return 0;
 }
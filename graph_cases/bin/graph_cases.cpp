@@ -1,42 +1,30 @@
+#include <algorithm>
+#include <array>
+#include <cstdint>
 #include <fstream>
 #include <functional>
 #include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "executer/chunked_task.h"
 #include "executer/executer.h"
+#include "executer/parallel_reducer.h"
 #include "local_types.h"
 #include "math_utils/combinatorics.h"
+#include "multipartite_graphs/acyclic_orintations.h"
 #include "multipartite_graphs/multipartite_graphs.h"
+#include "multithread_writer/mapped_writer.h"
+#include "multithread_writer/reorder_buffer.h"
 #include "multithread_writer/writer.h"
 #include "optparser/optparser.h"
-#include "utils/print.h"
-
-
-void WriteEdgeStat(size_t componentsNumber, const NMultipartiteGraphs::TEdgeSet& edgeSet, std::ostream& outp) {
-    std::vector<std::vector<int>> edgeStat(componentsNumber, std::vector<int>(componentsNumber, 0));
-
-    for (const auto& edge: edgeSet) {
-        auto firstComponent = edge.First.ComponentId;
-        auto secondComponent = edge.Second.ComponentId;
-        if (firstComponent > secondComponent) {
-            std::swap(firstComponent, secondComponent);
-        }
-
-        edgeStat[firstComponent][secondComponent] += 1;
-    }
-
-    bool first = true;
-    for (size_t i = 0; i + 1 != edgeStat.size(); ++i) {
-        for (size_t j = i + 1; j != edgeStat.size(); ++j) {
-            if (!first) {
-                outp << ", ";
-            }
-            outp << 'e' << i + 1 << j + 1 << '=' << edgeStat[i][j];
-            first = false;
-        }
-    }
-}
+#include "result_format/result_format.h"
+#include "singleton/singleton.h"
 
 
 struct TInvariantChecker {
@@ -64,21 +52,42 @@ static TInvariantChecker checkers[] = {
 struct TCompareOptions {
     bool ComputeAll = true;
     bool WriteEdgeSet = true;
+    // stop the search once a candidate passes every checker
+    bool FirstMatch = false;
+    // write NResultFormat records instead of text lines
+    bool Binary = false;
+    // count rejections instead of writing every candidate, only survivors are written
+    bool Summary = false;
+    // write results in the order of combination ranks
+    bool Ordered = false;
+    // chunks the reorder buffer may hold
+    size_t ReorderWindow = 1024;
+    // write fixed-width records straight into this file through a memory mapping
+    std::string MappedFile;
 };
 
-void CompareSourceAndDense(const NMultipartiteGraphs::TCompleteGraph& source, const NMultipartiteGraphs::TDenseGraph& target, std::ostream& outp, const TCompareOptions& options) {
-    if (options.WriteEdgeSet) {
-        PrintCollection(outp, target.DeletedEdges());
-    }
+constexpr size_t CheckersCount = sizeof(checkers) / sizeof(checkers[0]);
 
-    const std::string* reason = nullptr;
-    for (const auto& checker : checkers) {
-        auto sourceValue = checker.Checker(source);
-        auto targetValue = checker.Checker(target);
-        outp << checker.Name << ": " << targetValue << ' ';
+// a candidate graph with the rank of its deleted edge combination
+struct TCandidate {
+    uint64_t Rank;
+    NMultipartiteGraphs::TDenseGraph Graph;
+};
+
+/*
+ * Computes checker values of the target into values, returns the verdict
+ * (see NResultFormat::Match) and the number of computed values.
+ */
+uint8_t CompareSourceAndDense(const NMultipartiteGraphs::TCompleteGraph& source, const NMultipartiteGraphs::TDenseGraph& target, const TCompareOptions& options, uint64_t* values, size_t& count) {
+    uint8_t verdict = NResultFormat::Match;
+    count = 0;
+    for (size_t i = 0; i != CheckersCount; ++i) {
+        auto sourceValue = checkers[i].Checker(source);
+        auto targetValue = checkers[i].Checker(target);
+        values[count++] = targetValue;
         if (sourceValue != targetValue) {
-            if (reason == nullptr) {
-                reason = &checker.Name;
+            if (verdict == NResultFormat::Match) {
+                verdict = static_cast<uint8_t>(i + 1);
             }
 
             if (!options.ComputeAll) {
@@ -87,44 +96,273 @@ void CompareSourceAndDense(const NMultipartiteGraphs::TCompleteGraph& source, co
         }
     }
 
-    if (reason == nullptr) {
-        outp << "Answer: YES";
-    } else {
-        outp << "Answer: NO Reason: " << *reason;
+    return verdict;
+}
+
+NResultFormat::THeader CreateResultHeader(const NMultipartiteGraphs::TCompleteGraph& source, const NMultipartiteGraphs::TCompleteGraph& target, INT deletedEdges, const TCompareOptions& options) {
+    NResultFormat::THeader header;
+    header.Source.assign(source.begin(), source.end());
+    header.Target.assign(target.begin(), target.end());
+    header.DeletedEdges = deletedEdges;
+    for (const auto& checker : checkers) {
+        header.Checkers.push_back(checker.Name);
+    }
+
+    header.WriteEdgeSet = options.WriteEdgeSet;
+    header.ComputeAll = options.ComputeAll;
+    header.FixedWidth = !options.MappedFile.empty();
+    return header;
+}
+
+/*
+ * Edge statistics (see NResultFormat::ComputeEdgeStat) packed into one number without allocations:
+ * the number of deleted edges between a pair of components is a digit in base deletedEdges + 1,
+ * e12 is the lowest one. Fits() is false when the digits do not fit into 64 bits.
+ */
+class TEdgeStatPacker {
+public:
+    TEdgeStatPacker(size_t componentsNumber, uint64_t deletedEdges)
+        : ComponentsNumber(componentsNumber)
+        , Radix(deletedEdges + 1)
+        , PairWeights(componentsNumber * componentsNumber, 0)
+    {
+        uint64_t weight = 1;
+        for (size_t i = 0; i + 1 < componentsNumber; ++i) {
+            for (size_t j = i + 1; j != componentsNumber; ++j) {
+                PairWeights[i * componentsNumber + j] = weight;
+                if (weight > std::numeric_limits<uint64_t>::max() / Radix) {
+                    Fits_ = false;
+                }
+                weight *= Radix;
+                ++PairsNumber;
+            }
+        }
+    }
+
+    bool Fits() const {
+        return Fits_;
+    }
+
+    uint64_t Pack(const NMultipartiteGraphs::TEdgeSet& edgeSet) const {
+        uint64_t result = 0;
+        for (const auto& edge : edgeSet) {
+            auto first = std::min(edge.First.ComponentId, edge.Second.ComponentId);
+            auto second = std::max(edge.First.ComponentId, edge.Second.ComponentId);
+            result += PairWeights[first * ComponentsNumber + second];
+        }
+
+        return result;
+    }
+
+    std::vector<uint64_t> Unpack(uint64_t packed) const {
+        std::vector<uint64_t> result;
+        result.reserve(PairsNumber);
+        for (size_t i = 0; i != PairsNumber; ++i) {
+            result.push_back(packed % Radix);
+            packed /= Radix;
+        }
+
+        return result;
+    }
+
+private:
+    size_t ComponentsNumber;
+    uint64_t Radix;
+    std::vector<uint64_t> PairWeights;
+    size_t PairsNumber = 0;
+    bool Fits_ = true;
+};
+
+/*
+ * Number of candidates per verdict (see NResultFormat::Match),
+ * in total and per stratum of deleted edges between components.
+ * Strata are keyed by TEdgeStatPacker::Pack, or by the whole statistics if it does not fit.
+ */
+struct TSummary {
+    using TCounts = std::array<uint64_t, CheckersCount + 1>;
+
+    TCounts Total{};
+    std::unordered_map<uint64_t, TCounts> Strata;
+    std::map<std::vector<uint64_t>, TCounts> WideStrata;
+
+    void Add(uint8_t verdict, uint64_t packedEdgeStat) {
+        ++Total[verdict];
+        ++Strata[packedEdgeStat][verdict];
+    }
+
+    void Add(uint8_t verdict, std::vector<uint64_t>&& edgeStat) {
+        ++Total[verdict];
+        ++WideStrata[std::move(edgeStat)][verdict];
+    }
+
+    void Merge(const TSummary& other) {
+        for (size_t i = 0; i != Total.size(); ++i) {
+            Total[i] += other.Total[i];
+        }
+
+        for (const auto& [edgeStat, counts] : other.Strata) {
+            AddCounts(Strata[edgeStat], counts);
+        }
+
+        for (const auto& [edgeStat, counts] : other.WideStrata) {
+            AddCounts(WideStrata[edgeStat], counts);
+        }
+    }
+
+    static void AddCounts(TCounts& result, const TCounts& counts) {
+        for (size_t i = 0; i != counts.size(); ++i) {
+            result[i] += counts[i];
+        }
     }
+};
 
-    outp << ' ';
-    WriteEdgeStat(source.ComponentsNumber(), target.DeletedEdges(), outp);
-    outp << "\n";
+void WriteSummaryCounts(TOutputBuffer& out, const TSummary::TCounts& counts) {
+    for (size_t i = 0; i != CheckersCount; ++i) {
+        out << ' ' << checkers[i].Name << ": " << counts[i + 1];
+    }
+
+    out << " Survived: " << counts[NResultFormat::Match];
 }
 
-class TCompareGraphsTask : public ITask {
+void WriteSummary(std::ostream& out, const TSummary& summary, size_t componentsNumber, const TEdgeStatPacker& packer) {
+    auto strata = summary.WideStrata;
+    for (const auto& [packed, counts] : summary.Strata) {
+        TSummary::AddCounts(strata[packer.Unpack(packed)], counts);
+    }
+
+    TOutputBuffer buffer;
+    buffer << "Summary\n";
+    buffer << "Candidates: " << std::accumulate(summary.Total.begin(), summary.Total.end(), uint64_t{0}) << '\n';
+    buffer << "Rejected by";
+    WriteSummaryCounts(buffer, summary.Total);
+    buffer << '\n';
+    for (const auto& [edgeStat, counts] : strata) {
+        NResultFormat::WriteEdgeStat(componentsNumber, edgeStat, buffer);
+        buffer << ':';
+        WriteSummaryCounts(buffer, counts);
+        buffer << '\n';
+    }
+
+    out << buffer.Str() << std::flush;
+}
+
+using TReorder = TReorderBuffer<TWriter>;
+
+class TCompareGraphs {
 public:
-    TCompareGraphsTask(const NMultipartiteGraphs::TCompleteGraph& source, TWriter& writer, NMultipartiteGraphs::TDenseGraph target, TCompareOptions options)
+    TCompareGraphs(const NMultipartiteGraphs::TCompleteGraph& source, const NResultFormat::THeader& header, TWriter& writer, TMappedRecordWriter* mapped, TCompareOptions options, TCancellationToken* cancellation, TParallelReducer<TSummary>* summary, const TEdgeStatPacker* statPacker, TReorder* reorder, size_t chunkSize)
         : Source(source)
-        , Target(std::move(target))
+        , Header(header)
         , Writer(writer)
+        , Mapped(mapped)
         , Options(options)
+        , Cancellation(cancellation)
+        , Summary(summary)
+        , StatPacker(statPacker)
+        , Reorder(reorder)
+        , ChunkSize(chunkSize)
     {
     }
 
-    void Do() override {
-        std::stringstream ss;
-        CompareSourceAndDense(Source, Target, ss, Options);
-        ss.flush();
-        Writer.Push(ss.str());
+    void operator()(std::vector<TCandidate>& chunk) const {
+        if (Mapped != nullptr) {
+            TOutputBuffer unused;
+            for (const auto& candidate : chunk) {
+                Compare(candidate, unused);
+            }
+            return;
+        }
+
+        if (!Options.Ordered) {
+            // a lane is taken only for a row, summary mode writes almost nothing
+            for (const auto& candidate : chunk) {
+                TCheckResult result;
+                if (!Check(candidate, result)) {
+                    continue;
+                }
+
+                auto& lane = Writer.Lane();
+                Write(candidate, result, lane);
+                Writer.Commit(lane);
+            }
+            return;
+        }
+
+        // chunks hold consecutive ranks, so the first one identifies the chunk
+        TOutputBuffer block;
+        for (const auto& candidate : chunk) {
+            Compare(candidate, block);
+        }
+
+        Reorder->Push(chunk.front().Rank / ChunkSize, block.Take());
     }
 
 private:
+    struct TCheckResult {
+        uint8_t Verdict = NResultFormat::Match;
+        uint64_t Values[CheckersCount];
+        size_t Count = 0;
+    };
+
+    void Compare(const TCandidate& candidate, TOutputBuffer& out) const {
+        TCheckResult result;
+        if (Check(candidate, result)) {
+            Write(candidate, result, out);
+        }
+    }
+
+    // false if the candidate has no row
+    bool Check(const TCandidate& candidate, TCheckResult& result) const {
+        if (Options.FirstMatch && Cancellation->IsCancelled()) {
+            return false;
+        }
+
+        result.Verdict = CompareSourceAndDense(Source, candidate.Graph, Options, result.Values, result.Count);
+        if (Options.Summary) {
+            const auto& deletedEdges = candidate.Graph.DeletedEdges();
+            if (StatPacker->Fits()) {
+                Summary->Local().Add(result.Verdict, StatPacker->Pack(deletedEdges));
+            } else {
+                Summary->Local().Add(result.Verdict, NResultFormat::ComputeEdgeStat(Source.ComponentsNumber(), deletedEdges));
+            }
+            if (result.Verdict != NResultFormat::Match) {
+                return false;
+            }
+        }
+
+        if (result.Verdict == NResultFormat::Match && Options.FirstMatch) {
+            Cancellation->Cancel();
+        }
+        return true;
+    }
+
+    void Write(const TCandidate& candidate, const TCheckResult& result, TOutputBuffer& out) const {
+        if (Mapped != nullptr) {
+            NResultFormat::WriteFixedRecord(Mapped->Claim(), CheckersCount, candidate.Rank, result.Verdict, result.Values, result.Count);
+        } else if (Options.Binary) {
+            NResultFormat::WriteRecord(out, candidate.Rank, result.Verdict, result.Values, result.Count);
+        } else {
+            NResultFormat::WriteText(out, Header, Source.ComponentsNumber(), candidate.Graph.DeletedEdges(), result.Verdict, result.Values, result.Count);
+        }
+    }
+
     const NMultipartiteGraphs::TCompleteGraph& Source;
-    NMultipartiteGraphs::TDenseGraph Target;
+    const NResultFormat::THeader& Header;
     TWriter& Writer;
+    TMappedRecordWriter* Mapped;
     TCompareOptions Options;
+    TCancellationToken* Cancellation;
+    TParallelReducer<TSummary>* Summary;
+    const TEdgeStatPacker* StatPacker;
+    TReorder* Reorder;
+    size_t ChunkSize;
 };
 
 
 void compare_two_graphs(const NMultipartiteGraphs::TCompleteGraph& source, const NMultipartiteGraphs::TCompleteGraph& target,
-                        std::ostream& debug, int threadCount, const TCompareOptions& options) {
+                        std::ostream& out, const TExecuterOptions& executerOptions, size_t chunkSize, const TCompareOptions& options) {
+    // binary results can not be interleaved with the log
+    std::ostream& debug = options.Binary ? std::cerr : out;
     debug << "Checking graphs" << std::endl;
     debug << "Source: " << source << std::endl;
     debug << "Target: " << target << std::endl;
@@ -181,34 +419,98 @@ void compare_two_graphs(const NMultipartiteGraphs::TCompleteGraph& source, const
 
     std::vector<NMultipartiteGraphs::TEdge> allEdges = target.GenerateAllEdges();
 
-    TWriter writer{debug};
+    auto executer = CreateExecuter(executerOptions);
+    TParallelReducer<TSummary> summary(*executer, TSummary());
+    TEdgeStatPacker statPacker(source.ComponentsNumber(), edge_diff);
+    auto header = CreateResultHeader(source, target, edge_diff, options);
 
-    auto executer = CreateExecuter(threadCount, 1000, nullptr);
+    {
+        TWriter writer{out, executer.get()};
+        std::unique_ptr<TMappedRecordWriter> mapped;
+        if (!options.MappedFile.empty()) {
+            TOutputBuffer buffer;
+            NResultFormat::WriteHeader(buffer, header);
+            mapped = std::make_unique<TMappedRecordWriter>(options.MappedFile, buffer.Str(), NResultFormat::FixedRecordSize(CheckersCount));
+        } else if (options.Binary) {
+            TOutputBuffer buffer;
+            NResultFormat::WriteHeader(buffer, header);
+            writer.Push(buffer.Take());
+        }
 
-    size_t done = 0;
-    for (const auto& combination : TChoiceGenerator(allEdges.size(), edge_diff)) {
-        NMultipartiteGraphs::TEdgeSet current_edges;
-        for (const auto x: combination) {
-            current_edges.insert(allEdges[x]);
+        chunkSize = std::max<size_t>(chunkSize, 1);
+        TReorder reorder(writer, options.ReorderWindow);
+        {
+            TChunkedSubmitter<TCandidate, TCompareGraphs> submitter(*executer, TCompareGraphs(source, header, writer, mapped.get(), options, executer->CancellationToken().get(), &summary, &statPacker, &reorder, chunkSize), chunkSize);
+
+            size_t done = 0;
+            for (const auto& combination : TChoiceGenerator(allEdges.size(), edge_diff)) {
+                if (executer->IsCancelled()) {
+                    break;
+                }
+
+                // backpressure: a new chunk waits for the reorder buffer, chunks before it must be submitted
+                if (options.Ordered && done % chunkSize == 0 && !reorder.HasSlot(done / chunkSize)) {
+                    submitter.Flush();
+                    if (!reorder.WaitForSlot(done / chunkSize, executer->CancellationToken().get())) {
+                        break;
+                    }
+                }
+
+                NMultipartiteGraphs::TEdgeSet current_edges;
+                for (const auto x: combination) {
+                    current_edges.insert(allEdges[x]);
+                }
+
+                // combinations come in the order of CombinationRank
+                submitter.Add(TCandidate{done, NMultipartiteGraphs::TDenseGraph{target, std::move(current_edges)}});
+                done += 1;
+                if (done % 100000 == 0) {
+                    std::cerr << "done: " << done << ", queue size: " << executer->Size() << std::endl;
+                    if (executerOptions.CollectMetrics) {
+                        executer->DumpMetrics(std::cerr);
+                    }
+                    if (mapped) {
+                        mapped->Sync();
+                    }
+                }
+            }
         }
 
-        NMultipartiteGraphs::TDenseGraph newTarget{target, std::move(current_edges)};
-        executer->Add(std::make_unique<TCompareGraphsTask>(source, writer, std::move(newTarget), options));
-        done += 1;
-        if (done % 100000 == 0) {
-            std::cerr << "done: " << done << ", queue size: " << executer->Size() << std::endl;
+        std::cerr << "all pushed" << std::endl;
+        executer->Stop();
+        reorder.Finish();
+        if (mapped) {
+            mapped->Finish();
         }
     }
 
-    std::cerr << "all pushed" << std::endl;
-    executer->Stop();
+    if (executer->IsCancelled()) {
+        std::cerr << "stopped at the first match" << std::endl;
+    }
+
+    // the writer is flushed on destruction above, so survivors precede the summary
+    if (options.Summary) {
+        auto total = summary.Reduce([](TSummary& result, const TSummary& local) {
+            result.Merge(local);
+        });
+        WriteSummary(debug, total, source.ComponentsNumber(), statPacker);
+    }
 }
 
 struct TOptions {
     std::vector<INT> Source;
     std::vector<INT> Target;
     int ThreadCount = 1;
+    bool WorkStealing = false;
+    bool LockFreeQueue = false;
+    size_t ChunkSize = 1;
+    size_t PopBatchSize = 1;
+    std::string PinThreads;
+    bool Metrics = false;
     std::string OutputFile;
+    std::string OutputFormat;
+    std::string AcyclicCache;
+    size_t MemoBudgetMb = 0;
 
     TCompareOptions Options;
 
@@ -219,33 +521,86 @@ struct TOptions {
         parser.AddShortOption('s').AppendTo(&opts.Source).Required(true);
         parser.AddShortOption('t').AppendTo(&opts.Target).Required(true);
         parser.AddLongOption("thread-count").Store(&opts.ThreadCount).Default("6");
+        parser.AddLongOption("work-stealing").SetFlag(&opts.WorkStealing).Default("false");
+        parser.AddLongOption("lock-free-queue").SetFlag(&opts.LockFreeQueue).Default("false");
+        parser.AddLongOption("chunk-size").Store(&opts.ChunkSize).Default("64");
+        parser.AddLongOption("pop-batch-size").Store(&opts.PopBatchSize).Default("1");
+        parser.AddLongOption("pin-threads").Store(&opts.PinThreads).Default("none");
+        parser.AddLongOption("metrics").SetFlag(&opts.Metrics).Default("false");
         parser.AddLongOption("output-file").Store(&opts.OutputFile).Default("");
+        parser.AddLongOption("output-format").Store(&opts.OutputFormat).Default("text");
         parser.AddLongOption("compute-all").SetFlag(&opts.Options.ComputeAll).Default("false");
         parser.AddLongOption("write-all-edges").SetFlag(&opts.Options.WriteEdgeSet).Default("false");
+        parser.AddLongOption("first-match").SetFlag(&opts.Options.FirstMatch).Default("false");
+        parser.AddLongOption("summary").SetFlag(&opts.Options.Summary).Default("false");
+        parser.AddLongOption("ordered").SetFlag(&opts.Options.Ordered).Default("false");
+        parser.AddLongOption("reorder-window").Store(&opts.Options.ReorderWindow).Default("1024");
+        parser.AddLongOption("acyclic-cache").Store(&opts.AcyclicCache).Default("");
+        parser.AddLongOption("memo-budget-mb").Store(&opts.MemoBudgetMb).Default("0");
 
         parser.Parse(argc, argv);
 
+        if (opts.OutputFormat != "text" && opts.OutputFormat != "binary" && opts.OutputFormat != "fixed") {
+            throw std::invalid_argument("unknown output format: " + opts.OutputFormat);
+        }
+        opts.Options.Binary = opts.OutputFormat != "text";
+        if (opts.OutputFormat == "fixed") {
+            // records are placed in claim order, a file is needed for the mapping
+            if (opts.OutputFile.empty() || opts.Options.Ordered) {
+                throw std::invalid_argument("fixed output format needs --output-file and can not be --ordered");
+            }
+            opts.Options.MappedFile = opts.OutputFile;
+        }
+
         return opts;
     }
+
+    TExecuterOptions ExecuterOptions() const {
+        TExecuterOptions options;
+        options.ThreadCount = ThreadCount;
+        options.MaxQueueSize = 1000;
+        options.WorkStealing = WorkStealing;
+        options.LockFreeQueue = LockFreeQueue;
+        options.PopBatchSize = PopBatchSize;
+        options.Pinning = ParsePinPolicy(PinThreads);
+        if (options.Pinning != EPinPolicy::None) {
+            options.LayoutReport = &std::cerr;
+        }
+        options.CollectMetrics = Metrics;
+        options.MetricsReport = Metrics ? &std::cerr : nullptr;
+        return options;
+    }
 };
 
 
 int main(int argc, const char ** argv) {
     TOptions opts = TOptions::Parse(argc, argv);
+    auto& counter = TSingleton<NMultipartiteGraphs::TCompleteGraphAcyclicOrientationsCounter>::Instance();
+    counter.SetMemoBudget(opts.MemoBudgetMb << 20);
+    if (!opts.AcyclicCache.empty()) {
+        counter.AttachTable(opts.AcyclicCache);
+    }
+
     NMultipartiteGraphs::TCompleteGraph source(opts.Source.begin(), opts.Source.end());
     NMultipartiteGraphs::TCompleteGraph target(opts.Target.begin(), opts.Target.end());
 
     std::unique_ptr<std::ofstream> out(nullptr);
-    if (!opts.OutputFile.empty()) {
+    if (!opts.OutputFile.empty() && opts.Options.MappedFile.empty()) {
         out = std::make_unique<std::ofstream>();
-        out->open(opts.OutputFile);
+        out->open(opts.OutputFile, std::ios::out | std::ios::binary);
     }
 
-    compare_two_graphs(source, target, out ? *out : std::cout, opts.ThreadCount, opts.Options);
+    compare_two_graphs(source, target, out ? *out : std::cout, opts.ExecuterOptions(), opts.ChunkSize, opts.Options);
     if (out) {
         out->flush();
         out->close();
     }
 
+    counter.SaveTable();
+    if (opts.Metrics) {
+        auto stats = counter.MemoStats();
+        std::cerr << "acyclic memo size: " << stats.Size << ", capacity: " << stats.Capacity
+            << ", hits: " << stats.Hits << ", misses: " << stats.Misses << ", evictions: " << stats.Evictions << std::endl;
+    }
     return 0;
 }
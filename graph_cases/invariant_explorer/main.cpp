@@ -1,21 +1,44 @@
 #include "optparser/optparser.h"
+#include "binomial_coefficients/binomial_coefficients.h"
+#include "executer/chunked_task.h"
 #include "executer/executer.h"
+#include "executer/parallel_reducer.h"
 #include "math_utils/combinatorics.h"
 #include "multipartite_graphs/multipartite_graphs.h"
 #include "multithread_writer/writer.h"
 
 #include <iostream>
-#include <mutex>
 #include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
 #include <functional>
 #include <limits>
+#include <map>
+#include <memory>
+#include <optional>
+#include <random>
+#include <unordered_set>
+#include <unordered_map>
+#include <vector>
 
 struct TOptions {
     NMultipartiteGraphs::TCompleteGraph Graph;
     unsigned int MaxNumberOfEdges;
-    std::string Invariant;
+    std::vector<std::string> Invariants;
     int ThreadCount;
     size_t MaxQueueSize;
+    bool WorkStealing;
+    bool LockFreeQueue;
+    size_t ChunkSize;
+    unsigned int SplitDepth;
+    size_t PopBatchSize;
+    std::string PinThreads;
+    bool Metrics;
+    bool Histogram;
+    uint64_t Sample;
+    double TimeBudget;
+    uint64_t Seed;
 
     static TOptions ParseFromCommandLine(int argc, const char ** argv) {
         TOptions opts{};
@@ -33,7 +56,7 @@ struct TOptions {
 
         parser.AddLongOption('i', "invariant")
             .Default("i4")
-            .Store(&opts.Invariant);
+            .AppendTo(&opts.Invariants);
 
         parser.AddLongOption('t', "thread-count")
             .Default("1")
@@ -43,95 +66,422 @@ struct TOptions {
             .Default("1000")
             .Store(&opts.MaxQueueSize);
 
+        parser.AddLongOption("chunk-size")
+            .Default("1")
+            .Store(&opts.ChunkSize);
+
+        parser.AddLongOption("split-depth")
+            .Default("2")
+            .Store(&opts.SplitDepth);
+
+        parser.AddLongOption("pop-batch-size")
+            .Default("1")
+            .Store(&opts.PopBatchSize);
+
+        parser.AddLongOption("pin-threads")
+            .Default("none")
+            .Store(&opts.PinThreads);
+
+        parser.AddLongOption("metrics")
+            .Default("false")
+            .SetFlag(&opts.Metrics);
+
+        parser.AddLongOption("histogram")
+            .Default("false")
+            .SetFlag(&opts.Histogram);
+
+        parser.AddLongOption("sample")
+            .Default("0")
+            .Store(&opts.Sample);
+
+        parser.AddLongOption("time-budget")
+            .Default("0")
+            .Store(&opts.TimeBudget);
+
+        parser.AddLongOption("seed")
+            .Default("1")
+            .Store(&opts.Seed);
+
+        parser.AddLongOption("work-stealing")
+            .Default("false")
+            .SetFlag(&opts.WorkStealing);
+
+        parser.AddLongOption("lock-free-queue")
+            .Default("false")
+            .SetFlag(&opts.LockFreeQueue);
+
         parser.Parse(argc, argv);
 
         opts.Graph = {graph.begin(), graph.end()};
 
         return opts;
     }
+
+    TExecuterOptions ExecuterOptions() const {
+        TExecuterOptions options;
+        options.ThreadCount = ThreadCount;
+        options.MaxQueueSize = MaxQueueSize;
+        options.WorkStealing = WorkStealing;
+        options.LockFreeQueue = LockFreeQueue;
+        options.PopBatchSize = PopBatchSize;
+        options.Pinning = ParsePinPolicy(PinThreads);
+        if (options.Pinning != EPinPolicy::None) {
+            options.LayoutReport = &std::cerr;
+        }
+        options.CollectMetrics = Metrics;
+        options.MetricsReport = Metrics ? &std::cerr : nullptr;
+        return options;
+    }
 };
 
 
+/*
+ * Extreme values for a number of deleted edges and, if requested,
+ * the exact number of graphs for every value.
+ */
 template<typename TNumber>
 struct TResult {
     unsigned int NumberOfEdges;
     TNumber MaxValue = std::numeric_limits<TNumber>::min();
     TNumber MinValue = std::numeric_limits<TNumber>::max();
+    bool CollectHistogram = false;
+    std::unordered_map<TNumber, unsigned long long> Histogram;
 
-    TResult(unsigned int numberOfEdges)
+    TResult(unsigned int numberOfEdges, bool collectHistogram = false)
         : NumberOfEdges(numberOfEdges)
         , MaxValue{std::numeric_limits<TNumber>::min()}
         , MinValue{std::numeric_limits<TNumber>::max()}
+        , CollectHistogram(collectHistogram)
     {
     }
+
+    TResult& Add(TNumber value) {
+        MaxValue = std::max(MaxValue, value);
+        MinValue = std::min(MinValue, value);
+        if (CollectHistogram) {
+            ++Histogram[value];
+        }
+        return *this;
+    }
+
+    TResult& Merge(const TResult& other) {
+        MaxValue = std::max(MaxValue, other.MaxValue);
+        MinValue = std::min(MinValue, other.MinValue);
+        for (const auto& [value, count] : other.Histogram) {
+            Histogram[value] += count;
+        }
+        return *this;
+    }
+
+    // "value:count" pairs in the increasing order of values
+    void WriteHistogram(std::ostream& out) const {
+        std::map<TNumber, unsigned long long> sorted(Histogram.begin(), Histogram.end());
+        for (const auto& [value, count] : sorted) {
+            out << " " << value << ":" << count;
+        }
+    }
 };
 
+/*
+ * Results for every invariant and every number of edges, one copy per worker thread,
+ * so evaluations never synchronize with each other.
+ */
 template<typename TNumber>
-class TResultCollector {
-public:
-    TResultCollector(unsigned int numberOfEdges)
-        : Result(numberOfEdges)
-        , Mutex{}
+using TResultTable = std::vector<std::vector<TResult<TNumber>>>;
+
+template<typename TNumber>
+using TResultReducer = TParallelReducer<TResultTable<TNumber>>;
+
+template<typename TNumber>
+TResultTable<TNumber> MergeResults(const TResultReducer<TNumber>& reducer) {
+    return reducer.Reduce([](TResultTable<TNumber>& result, const TResultTable<TNumber>& local) {
+        for (size_t invariant = 0; invariant != result.size(); ++invariant) {
+            for (size_t i = 0; i != result[invariant].size(); ++i) {
+                result[invariant][i].Merge(local[invariant][i]);
+            }
+        }
+    });
+}
+
+/*
+ * Evaluates every requested invariant on the same graph,
+ * so they share its construction and the values it caches.
+ */
+template<typename TNumber>
+struct TEvaluator {
+    using TInvariant = NMultipartiteGraphs::TInvariant<TNumber>;
+
+    TEvaluator(const std::vector<TInvariant>& invariants, TResultReducer<TNumber>* reducer)
+        : Reducer(reducer)
+        , Invariants(invariants)
     {
     }
 
-    inline TResult<TNumber> GetResult() const {
-        return Result;
+    void operator()(const NMultipartiteGraphs::TDenseGraph& graph) const {
+        auto& local = Reducer->Local();
+        size_t resultIndex = graph.DeletedEdges().size() - 1;
+        for (size_t i = 0; i != Invariants.size(); ++i) {
+            local[i][resultIndex].Add(Invariants[i](graph));
+        }
     }
 
-    TResultCollector& Add(unsigned int value) {
-        std::unique_lock<std::mutex> lock{Mutex};
-        Result.MaxValue = std::max(Result.MaxValue, value);
-        Result.MinValue = std::min(Result.MinValue, value);
-        return *this;
+    TResultReducer<TNumber>* Reducer;
+    std::vector<TInvariant> Invariants;
+};
+
+/*
+ * Root of a subtree in the depth-first tree of deleted edge subsets:
+ * indices of the deleted edges in increasing order, children delete one more edge with a larger index.
+ */
+struct TSubtreeRoot {
+    std::vector<size_t> Edges;
+    bool Expand = false;
+};
+
+/*
+ * Evaluates a root built from scratch and, if it is expanded, walks its subtree.
+ * Every child is a copy of its parent with one more deleted edge,
+ * so the invariants the parent has computed are updated by the delta (see TDenseGraph::DeleteEdge).
+ */
+template<typename TNumber>
+struct TSubtreeWalker {
+    TSubtreeWalker(const NMultipartiteGraphs::TCompleteGraph& graph, std::shared_ptr<const std::vector<NMultipartiteGraphs::TEdge>> allEdges, unsigned int maxNumberOfEdges, const TEvaluator<TNumber>& evaluator)
+        : Graph(&graph)
+        , AllEdges(std::move(allEdges))
+        , MaxNumberOfEdges(maxNumberOfEdges)
+        , Evaluator(evaluator)
+    {
     }
 
-private:
-    TResult<TNumber> Result;
-    std::mutex Mutex;
+    void operator()(const TSubtreeRoot& root) const {
+        NMultipartiteGraphs::TEdgeSet edgeSet;
+        for (auto i : root.Edges) {
+            edgeSet.insert((*AllEdges)[i]);
+        }
+
+        NMultipartiteGraphs::TDenseGraph graph{*Graph, std::move(edgeSet)};
+        Evaluator(graph);
+        if (root.Expand) {
+            Walk(graph, root.Edges.back() + 1);
+        }
+    }
+
+    void Walk(const NMultipartiteGraphs::TDenseGraph& parent, size_t firstEdge) const {
+        if (parent.DeletedEdges().size() == MaxNumberOfEdges) {
+            return;
+        }
+
+        for (size_t i = firstEdge; i < AllEdges->size(); ++i) {
+            auto child = parent.DeleteEdge((*AllEdges)[i]);
+            Evaluator(child);
+            Walk(child, i + 1);
+        }
+    }
+
+    const NMultipartiteGraphs::TCompleteGraph* Graph;
+    // shared by the tasks, which may outlive CheckAllEdges
+    std::shared_ptr<const std::vector<NMultipartiteGraphs::TEdge>> AllEdges;
+    unsigned int MaxNumberOfEdges;
+    TEvaluator<TNumber> Evaluator;
 };
 
+
+/*
+ * Subsets with at most splitDepth edges are submitted one by one,
+ * the ones with exactly splitDepth edges also walk their subtrees.
+ */
 template<typename TNumber>
-struct TTask : public ITask {
-    using TInvariant = NMultipartiteGraphs::TInvariant<TNumber>;
+void CheckAllEdges(const NMultipartiteGraphs::TCompleteGraph& graph, unsigned int maxNumberOfEdges, unsigned int splitDepth, const std::vector<typename TEvaluator<TNumber>::TInvariant>& invariants, IExecuter* executer, size_t chunkSize, TResultReducer<TNumber>* reducer) {
+    auto allEdges = std::make_shared<const std::vector<NMultipartiteGraphs::TEdge>>(graph.GenerateAllEdges());
+    splitDepth = std::max(1u, std::min(splitDepth, maxNumberOfEdges));
+    TSubtreeWalker<TNumber> walker(graph, allEdges, maxNumberOfEdges, TEvaluator<TNumber>(invariants, reducer));
+    TChunkedSubmitter<TSubtreeRoot, TSubtreeWalker<TNumber>> submitter(*executer, walker, chunkSize);
+    for (unsigned int numberOfEdges = 1; numberOfEdges <= splitDepth && numberOfEdges <= allEdges->size(); ++numberOfEdges) {
+        for (const auto& combination : TChoiceGenerator(allEdges->size(), numberOfEdges)) {
+            submitter.Add(TSubtreeRoot{combination, numberOfEdges == splitDepth});
+        }
+    }
+    submitter.Flush();
+}
 
-    TTask(NMultipartiteGraphs::TDenseGraph&& graph, const TInvariant& invariant, TResultCollector<TNumber>* collector)
-        : Graph(graph)
-        , Collector(collector)
-        , Invariant(invariant)
+/*
+ * Uniform random k-subsets of {0, ..., n - 1} in increasing order:
+ * a uniform rank unranked by CombinationUnrank while C(n, k) fits into 64 bits,
+ * Floyd's algorithm otherwise.
+ */
+class TSubsetSampler {
+public:
+    TSubsetSampler(size_t n, size_t k)
+        : N(n)
+        , K(k)
+        , Count(CountCombinations(n, k))
     {
     }
 
-    void Do() override {
-        Collector->Add(Invariant(Graph));
+    template<typename TRandom>
+    std::vector<size_t> operator()(TRandom& random) const {
+        if (Count) {
+            return CombinationUnrank(N, K, std::uniform_int_distribution<uint64_t>(0, *Count - 1)(random));
+        }
+
+        std::unordered_set<size_t> chosen;
+        for (size_t j = N - K; j != N; ++j) {
+            size_t value = std::uniform_int_distribution<size_t>(0, j)(random);
+            chosen.insert(chosen.count(value) ? j : value);
+        }
+
+        std::vector<size_t> result(chosen.begin(), chosen.end());
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+private:
+    // nothing if the number does not fit into a long long
+    static std::optional<uint64_t> CountCombinations(size_t n, size_t k) {
+        uint64_t result = 1;
+        for (size_t i = 0; i != k; ++i) {
+            if (result > static_cast<uint64_t>(std::numeric_limits<long long>::max()) / (n - i)) {
+                return std::nullopt;
+            }
+            result = result * (n - i) / (i + 1);
+        }
+
+        return result;
     }
 
-    NMultipartiteGraphs::TDenseGraph Graph;
-    TResultCollector<TNumber>* Collector;
-    TInvariant Invariant;
+    size_t N;
+    size_t K;
+    std::optional<uint64_t> Count;
 };
 
+/*
+ * Samples subsets for every number of edges in turn, each task has its own random stream,
+ * so the results of --sample do not depend on the scheduling.
+ */
+struct TSampleTask {
+    uint64_t Stream;
+    uint64_t Rounds;
+};
 
 template<typename TNumber>
-std::deque<TResultCollector<TNumber>> CheckAllEdges(const NMultipartiteGraphs::TCompleteGraph& graph, unsigned int maxNumberOfEdges, const typename TTask<TNumber>::TInvariant& invariant, IExecuter* executer) {
-    auto allEdges = graph.GenerateAllEdges();
-    std::deque<TResultCollector<TNumber>> collectors;
-    for (unsigned int numberOfEdges = 1; numberOfEdges <= maxNumberOfEdges; ++numberOfEdges) {
-        collectors.emplace_back(numberOfEdges);
-        for (const auto& combination : TChoiceGenerator(allEdges.size(), numberOfEdges)) {
-            NMultipartiteGraphs::TEdgeSet edgeSet;
-            for (auto i : combination) {
-                edgeSet.insert(allEdges[i]);
+struct TSampler {
+    TSampler(const NMultipartiteGraphs::TCompleteGraph& graph, std::shared_ptr<const std::vector<NMultipartiteGraphs::TEdge>> allEdges, unsigned int maxNumberOfEdges, const TEvaluator<TNumber>& evaluator, uint64_t seed, std::optional<std::chrono::steady_clock::time_point> deadline)
+        : Graph(&graph)
+        , AllEdges(std::move(allEdges))
+        , Evaluator(evaluator)
+        , Seed(seed)
+        , Deadline(deadline)
+    {
+        for (unsigned int numberOfEdges = 1; numberOfEdges <= maxNumberOfEdges; ++numberOfEdges) {
+            Samplers.emplace_back(AllEdges->size(), numberOfEdges);
+        }
+    }
+
+    void operator()(const TSampleTask& task) const {
+        // seed_seq keeps 32 bits of every value, so both halves are passed
+        std::seed_seq seedSequence{
+            static_cast<uint32_t>(Seed), static_cast<uint32_t>(Seed >> 32),
+            static_cast<uint32_t>(task.Stream), static_cast<uint32_t>(task.Stream >> 32)
+        };
+        std::mt19937_64 random(seedSequence);
+        for (uint64_t round = 0; round != task.Rounds; ++round) {
+            if (Deadline && std::chrono::steady_clock::now() >= *Deadline) {
+                return;
+            }
+
+            for (const auto& sampler : Samplers) {
+                NMultipartiteGraphs::TEdgeSet edgeSet;
+                for (auto i : sampler(random)) {
+                    edgeSet.insert((*AllEdges)[i]);
+                }
+                Evaluator(NMultipartiteGraphs::TDenseGraph{*Graph, std::move(edgeSet)});
+            }
+        }
+    }
+
+    const NMultipartiteGraphs::TCompleteGraph* Graph;
+    std::shared_ptr<const std::vector<NMultipartiteGraphs::TEdge>> AllEdges;
+    std::vector<TSubsetSampler> Samplers;
+    TEvaluator<TNumber> Evaluator;
+    uint64_t Seed;
+    std::optional<std::chrono::steady_clock::time_point> Deadline;
+};
+
+constexpr uint64_t RoundsPerSampleTask = 64;
+
+/*
+ * Monte Carlo version of CheckAllEdges: `samples` uniform subsets for every number of edges,
+ * or as many as fit into the time budget (in seconds) if it is positive.
+ */
+template<typename TNumber>
+void SampleEdges(const NMultipartiteGraphs::TCompleteGraph& graph, unsigned int maxNumberOfEdges, uint64_t samples, double timeBudget, uint64_t seed, const std::vector<typename TEvaluator<TNumber>::TInvariant>& invariants, IExecuter* executer, size_t chunkSize, TResultReducer<TNumber>* reducer) {
+    auto allEdges = std::make_shared<const std::vector<NMultipartiteGraphs::TEdge>>(graph.GenerateAllEdges());
+    // fills the shared table of binomial coefficients before the workers read it
+    BinomialCoefficient(allEdges->size(), allEdges->size() / 2);
+
+    std::optional<std::chrono::steady_clock::time_point> deadline;
+    if (timeBudget > 0) {
+        deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(timeBudget));
+    }
+
+    TSampler<TNumber> sampler(graph, allEdges, maxNumberOfEdges, TEvaluator<TNumber>(invariants, reducer), seed, deadline);
+    TChunkedSubmitter<TSampleTask, TSampler<TNumber>> submitter(*executer, sampler, chunkSize);
+    if (samples == 0) {
+        for (uint64_t stream = 0; stream != std::max<uint64_t>(1, executer->ThreadCount()); ++stream) {
+            submitter.Add(TSampleTask{stream, std::numeric_limits<uint64_t>::max()});
+        }
+    } else {
+        for (uint64_t stream = 0; stream * RoundsPerSampleTask < samples; ++stream) {
+            submitter.Add(TSampleTask{stream, std::min(RoundsPerSampleTask, samples - stream * RoundsPerSampleTask)});
+        }
+    }
+    submitter.Flush();
+}
+
+/*
+ * Estimation of the q-quantile from a sample histogram and its distribution-free 95% confidence interval:
+ * the order statistics around n * q within 1.96 standard deviations of the binomial distribution.
+ */
+template<typename TNumber>
+void WriteQuantile(std::ostream& out, const TResult<TNumber>& result, double q) {
+    std::map<TNumber, unsigned long long> sorted(result.Histogram.begin(), result.Histogram.end());
+    unsigned long long n = 0;
+    for (const auto& [value, count] : sorted) {
+        n += count;
+    }
+
+    auto at = [&sorted](double rank) {
+        unsigned long long seen = 0;
+        for (const auto& [value, count] : sorted) {
+            seen += count;
+            if (static_cast<double>(seen) >= rank) {
+                return value;
             }
-            executer->Add(std::make_unique<TTask<TNumber>>(NMultipartiteGraphs::TDenseGraph{graph, std::move(edgeSet)}, invariant, &collectors.back()));
         }
+        return sorted.rbegin()->first;
+    };
+
+    double deviation = 1.96 * std::sqrt(n * q * (1 - q));
+    double last = static_cast<double>(n);
+    out << " q" << q * 100 << "=" << at(std::clamp(std::ceil(n * q), 1.0, last))
+        << "[" << at(std::clamp(std::floor(n * q - deviation), 1.0, last))
+        << "," << at(std::clamp(std::ceil(n * q + deviation), 1.0, last)) << "]";
+}
+
+constexpr double Quantiles[] = {0.05, 0.25, 0.5, 0.75, 0.95};
+
+template<typename TNumber>
+TResultTable<TNumber> MakeEmptyResults(size_t invariantsCount, unsigned int maxNumberOfEdges, bool collectHistogram) {
+    std::vector<TResult<TNumber>> results;
+    for (unsigned int numberOfEdges = 1; numberOfEdges <= maxNumberOfEdges; ++numberOfEdges) {
+        results.emplace_back(numberOfEdges, collectHistogram);
     }
 
-    return collectors;
+    return TResultTable<TNumber>(invariantsCount, results);
 }
 
 
-TTask<unsigned int>::TInvariant MakeInvariant(const std::string& name) {
+TEvaluator<unsigned int>::TInvariant MakeInvariant(const std::string& name) {
     if (name == "i4") {
         return &NMultipartiteGraphs::IGraph::I4Invariant;
     }
@@ -143,16 +493,63 @@ TTask<unsigned int>::TInvariant MakeInvariant(const std::string& name) {
     throw std::logic_error("unknown invariant: " + name);
 }
 
+std::vector<TEvaluator<unsigned int>::TInvariant> MakeInvariants(const std::vector<std::string>& names) {
+    std::vector<TEvaluator<unsigned int>::TInvariant> invariants;
+    for (const auto& name : names) {
+        invariants.push_back(MakeInvariant(name));
+    }
+
+    return invariants;
+}
+
 int main(int argc, const char ** argv) {
     auto options = TOptions::ParseFromCommandLine(argc, argv);
     const auto& graph = options.Graph;
-    auto executer = CreateExecuter(options.ThreadCount, options.MaxQueueSize, nullptr);
+    auto executer = CreateExecuter(options.ExecuterOptions());
     unsigned int maxNumberOfEdges = (options.MaxNumberOfEdges == 0) ? graph.I2Invariant() : options.MaxNumberOfEdges;
-    auto collectors = CheckAllEdges<unsigned int>(graph, maxNumberOfEdges, MakeInvariant(options.Invariant), executer.get());
+    auto invariants = MakeInvariants(options.Invariants);
+    bool sampling = options.Sample != 0 || options.TimeBudget > 0;
+    if (sampling) {
+        maxNumberOfEdges = std::min<unsigned int>(maxNumberOfEdges, graph.I2Invariant());
+    }
+
+    TResultReducer<unsigned int> reducer(*executer, MakeEmptyResults<unsigned int>(invariants.size(), maxNumberOfEdges, options.Histogram || sampling));
+    if (sampling) {
+        SampleEdges<unsigned int>(graph, maxNumberOfEdges, options.Sample, options.TimeBudget, options.Seed, invariants, executer.get(), options.ChunkSize, &reducer);
+    } else {
+        CheckAllEdges<unsigned int>(graph, maxNumberOfEdges, options.SplitDepth, invariants, executer.get(), options.ChunkSize, &reducer);
+    }
     executer->Stop();
 
-    for (const auto& collector : collectors) {
-        auto result = collector.GetResult();
-        std::cout << result.NumberOfEdges << " " << result.MinValue << " " << result.MaxValue << std::endl;
+    // a single invariant keeps the plain "edges min max" lines, several are prefixed by the invariant name;
+    // sampling appends the number of samples and quantile estimates "q<percent>=value[low,high]"
+    // (min and max are the sample ones then),
+    // --histogram appends the number of distinct values and "value:count" pairs
+    auto results = MergeResults(reducer);
+    for (size_t i = 0; i != results.size(); ++i) {
+        for (const auto& result : results[i]) {
+            if (results.size() > 1) {
+                std::cout << options.Invariants[i] << " ";
+            }
+            std::cout << result.NumberOfEdges << " " << result.MinValue << " " << result.MaxValue;
+            if (sampling) {
+                unsigned long long samples = 0;
+                for (const auto& [value, count] : result.Histogram) {
+                    samples += count;
+                }
+
+                std::cout << " " << samples;
+                if (samples != 0) {
+                    for (auto q : Quantiles) {
+                        WriteQuantile(std::cout, result, q);
+                    }
+                }
+            }
+            if (options.Histogram) {
+                std::cout << " " << result.Histogram.size();
+                result.WriteHistogram(std::cout);
+            }
+            std::cout << std::endl;
+        }
     }
 }
\ No newline at end of file
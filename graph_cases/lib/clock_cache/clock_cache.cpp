@@ -0,0 +1 @@
+#include "clock_cache.h"
@@ -0,0 +1,249 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <vector>
+
+struct TCacheStats {
+    uint64_t Hits = 0;
+    uint64_t Misses = 0;
+    uint64_t Evictions = 0;
+    size_t Size = 0;
+    size_t Capacity = 0;
+};
+
+/*
+ * Memo with a bounded number of entries and CLOCK eviction.
+ * Entries live inline in an open-addressing table with linear probing,
+ * a hit only sets the reference bit of the entry. When the cache is full,
+ * the clock hand sweeps the table, clears reference bits
+ * and evicts the first entry which was not referenced since the last sweep.
+ * A zero capacity means an unbounded cache which grows instead of evicting.
+ *
+ * Find may be called concurrently with other Find calls (e.g. under a shared lock),
+ * Insert needs exclusive access.
+ */
+template<typename TKey, typename TValue, typename THash = std::hash<TKey>>
+class TClockCache {
+public:
+    explicit TClockCache(size_t capacity = 0) {
+        Reset(capacity);
+    }
+
+    TClockCache(const TClockCache&) = delete;
+
+    TClockCache& operator=(const TClockCache&) = delete;
+
+    // capacity whose table, free slots included, fits into the memory budget, zero is unbounded;
+    // the table has at least two slots whatever the budget
+    static size_t CapacityForBudget(size_t bytes) {
+        if (bytes == 0) {
+            return 0;
+        }
+
+        size_t tableSize = 2;
+        while (2 * tableSize * sizeof(TSlot) <= bytes) {
+            tableSize <<= 1;
+        }
+
+        return tableSize / 2;
+    }
+
+    // drops every entry and the statistics
+    void Reset(size_t capacity) {
+        Capacity = capacity;
+        // a bounded table is exactly twice the capacity rounded up to a power of two
+        size_t tableSize = Capacity == 0 ? 16 : 2;
+        while (tableSize < 2 * Capacity) {
+            tableSize <<= 1;
+        }
+
+        Slots = std::vector<TSlot>(tableSize);
+        Size_ = 0;
+        Hand = 0;
+        Evictions = 0;
+        Hits.store(0, std::memory_order_relaxed);
+        Misses.store(0, std::memory_order_relaxed);
+    }
+
+    std::optional<TValue> Find(const TKey& key) const {
+        const TSlot* slot = FindSlot(key);
+        if (slot == nullptr) {
+            Misses.fetch_add(1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+
+        Hits.fetch_add(1, std::memory_order_relaxed);
+        if (!slot->Referenced.load(std::memory_order_relaxed)) {
+            slot->Referenced.store(true, std::memory_order_relaxed);
+        }
+
+        return slot->Value;
+    }
+
+    void Insert(const TKey& key, const TValue& value) {
+        if (TSlot* slot = const_cast<TSlot*>(FindSlot(key))) {
+            slot->Value = value;
+            return;
+        }
+
+        if (Capacity == 0) {
+            if (2 * (Size_ + 1) > Slots.size()) {
+                Rehash(2 * Slots.size());
+            }
+        } else if (Size_ == Capacity) {
+            Evict();
+        }
+
+        size_t index = Index(key);
+        while (Slots[index].Occupied) {
+            index = Next(index);
+        }
+
+        auto& slot = Slots[index];
+        slot.Key = key;
+        slot.Value = value;
+        slot.Occupied = true;
+        slot.Referenced.store(false, std::memory_order_relaxed);
+        ++Size_;
+    }
+
+    size_t Size() const {
+        return Size_;
+    }
+
+    // memory of the table
+    size_t MemoryBytes() const {
+        return Slots.size() * sizeof(TSlot);
+    }
+
+    template<typename TFunc>
+    void ForEach(TFunc&& func) const {
+        for (const auto& slot : Slots) {
+            if (slot.Occupied) {
+                func(slot.Key, slot.Value);
+            }
+        }
+    }
+
+    TCacheStats Stats() const {
+        TCacheStats stats;
+        stats.Hits = Hits.load(std::memory_order_relaxed);
+        stats.Misses = Misses.load(std::memory_order_relaxed);
+        stats.Evictions = Evictions;
+        stats.Size = Size_;
+        stats.Capacity = Capacity;
+        return stats;
+    }
+
+private:
+    struct TSlot {
+        TKey Key{};
+        TValue Value{};
+        bool Occupied = false;
+        mutable std::atomic<bool> Referenced{false};
+
+        TSlot() = default;
+
+        TSlot(const TSlot& other)
+            : Key(other.Key)
+            , Value(other.Value)
+            , Occupied(other.Occupied)
+            , Referenced(other.Referenced.load(std::memory_order_relaxed))
+        {
+        }
+
+        TSlot& operator=(const TSlot& other) {
+            Key = other.Key;
+            Value = other.Value;
+            Occupied = other.Occupied;
+            Referenced.store(other.Referenced.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            return *this;
+        }
+    };
+
+    size_t Index(const TKey& key) const {
+        return THash()(key) & (Slots.size() - 1);
+    }
+
+    size_t Next(size_t index) const {
+        return (index + 1) & (Slots.size() - 1);
+    }
+
+    const TSlot* FindSlot(const TKey& key) const {
+        for (size_t index = Index(key);; index = Next(index)) {
+            const auto& slot = Slots[index];
+            if (!slot.Occupied) {
+                return nullptr;
+            }
+
+            if (slot.Key == key) {
+                return &slot;
+            }
+        }
+    }
+
+    void Evict() {
+        while (true) {
+            auto& slot = Slots[Hand];
+            if (slot.Occupied) {
+                if (!slot.Referenced.load(std::memory_order_relaxed)) {
+                    Erase(Hand);
+                    ++Evictions;
+                    return;
+                }
+
+                slot.Referenced.store(false, std::memory_order_relaxed);
+            }
+
+            Hand = Next(Hand);
+        }
+    }
+
+    // backward shift deletion keeps probe sequences without tombstones
+    void Erase(size_t index) {
+        size_t hole = index;
+        for (size_t current = Next(index); Slots[current].Occupied; current = Next(current)) {
+            size_t home = Index(Slots[current].Key);
+            // the entry may move to the hole if its home is not within (hole, current]
+            bool movable = (hole <= current) ? (home <= hole || home > current) : (home <= hole && home > current);
+            if (movable) {
+                Slots[hole] = Slots[current];
+                hole = current;
+            }
+        }
+
+        Slots[hole] = TSlot();
+        --Size_;
+    }
+
+    void Rehash(size_t tableSize) {
+        std::vector<TSlot> old(tableSize);
+        old.swap(Slots);
+        Size_ = 0;
+        Hand = 0;
+        for (const auto& slot : old) {
+            if (slot.Occupied) {
+                size_t index = Index(slot.Key);
+                while (Slots[index].Occupied) {
+                    index = Next(index);
+                }
+
+                Slots[index] = slot;
+                ++Size_;
+            }
+        }
+    }
+
+    size_t Capacity = 0;
+    std::vector<TSlot> Slots;
+    size_t Size_ = 0;
+    size_t Hand = 0;
+    uint64_t Evictions = 0;
+    mutable std::atomic<uint64_t> Hits{0};
+    mutable std::atomic<uint64_t> Misses{0};
+};
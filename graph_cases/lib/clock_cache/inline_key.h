@@ -0,0 +1,87 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+/*
+ * Short sequence of small numbers stored inline, without a heap allocation.
+ * A sequence which is too long or has a too large element is not representable,
+ * see Assign.
+ */
+template<typename TElement, size_t Capacity>
+class TInlineKey {
+public:
+    static_assert(Capacity <= std::numeric_limits<uint8_t>::max(), "the length is stored in a byte");
+
+    TInlineKey() = default;
+
+    // false if the range does not fit, the key is unchanged then
+    template<typename TIterator>
+    bool Assign(TIterator begin, TIterator end) {
+        size_t length = 0;
+        for (auto iter = begin; iter != end; ++iter, ++length) {
+            if (length == Capacity || !Fits(*iter)) {
+                return false;
+            }
+        }
+
+        Elements = {};
+        std::copy(begin, end, Elements.begin());
+        Length = static_cast<uint8_t>(length);
+        return true;
+    }
+
+    const TElement* begin() const {
+        return Elements.data();
+    }
+
+    const TElement* end() const {
+        return Elements.data() + Length;
+    }
+
+    size_t Size() const {
+        return Length;
+    }
+
+    bool operator==(const TInlineKey& other) const {
+        return Length == other.Length && Elements == other.Elements;
+    }
+
+    bool operator!=(const TInlineKey& other) const {
+        return !(*this == other);
+    }
+
+    size_t Hash() const {
+        uint64_t result = 14695981039346656037ull ^ Length;
+        for (size_t i = 0; i != Length; ++i) {
+            result = (result ^ Elements[i]) * 1099511628211ull;
+        }
+
+        return static_cast<size_t>(result ^ (result >> 29));
+    }
+
+    struct THasher {
+        size_t operator()(const TInlineKey& key) const {
+            return key.Hash();
+        }
+    };
+
+private:
+    template<typename TValue>
+    static bool Fits(TValue value) {
+        if constexpr (std::is_signed_v<TValue>) {
+            if (value < 0) {
+                return false;
+            }
+        }
+
+        return static_cast<std::make_unsigned_t<TValue>>(value) <= std::numeric_limits<TElement>::max();
+    }
+
+    std::array<TElement, Capacity> Elements{};
+    uint8_t Length = 0;
+};
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <atomic>
+
+/*
+ * Cooperative stop flag shared between a producer, an executer and its tasks.
+ * Nothing is interrupted: whoever holds the token polls it and stops on its own.
+ */
+class TCancellationToken {
+public:
+    // returns true for the call which actually cancelled
+    bool Cancel() {
+        return !Cancelled.exchange(true, std::memory_order_acq_rel);
+    }
+
+    bool IsCancelled() const {
+        return Cancelled.load(std::memory_order_acquire);
+    }
+
+private:
+    std::atomic<bool> Cancelled{false};
+};
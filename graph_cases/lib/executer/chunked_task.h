@@ -0,0 +1,103 @@
+#pragma once
+
+#include "executer.h"
+
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+ * Task which applies a function to a chunk of items,
+ * so the dispatch cost is paid once per chunk instead of once per item.
+ * A function which accepts the whole chunk (std::vector<TItem>&) gets it at once.
+ */
+template<typename TItem, typename TFunc>
+class TChunkedTask {
+public:
+    TChunkedTask(std::vector<TItem>&& items, const TFunc& func)
+        : Items(std::move(items))
+        , Func(func)
+    {
+    }
+
+    void operator()() {
+        if constexpr (std::is_invocable_v<TFunc&, std::vector<TItem>&>) {
+            Func(Items);
+        } else {
+            for (auto& item : Items) {
+                Func(item);
+            }
+        }
+    }
+
+private:
+    std::vector<TItem> Items;
+    TFunc Func;
+};
+
+template<typename TItem, typename TFunc>
+TInlineTask CreateChunkedTask(std::vector<TItem>&& items, const TFunc& func) {
+    return TInlineTask(TChunkedTask<TItem, TFunc>(std::move(items), func));
+}
+
+/*
+ * Groups items into chunks of ChunkSize and submits the chunk tasks
+ * to the executer in batches of BatchSize.
+ * Everything left is submitted on Flush or destruction.
+ */
+template<typename TItem, typename TFunc>
+class TChunkedSubmitter {
+public:
+    TChunkedSubmitter(IExecuter& executer, TFunc func, size_t chunkSize, size_t batchSize = 16)
+        : Executer(executer)
+        , Func(std::move(func))
+        , ChunkSize(chunkSize == 0 ? 1 : chunkSize)
+        , BatchSize(batchSize == 0 ? 1 : batchSize)
+    {
+        Chunk.reserve(ChunkSize);
+    }
+
+    TChunkedSubmitter(const TChunkedSubmitter&) = delete;
+
+    TChunkedSubmitter& operator=(const TChunkedSubmitter&) = delete;
+
+    void Add(TItem&& item) {
+        Chunk.push_back(std::move(item));
+        if (Chunk.size() == ChunkSize) {
+            FlushChunk();
+            if (Batch.size() == BatchSize) {
+                Executer.AddBatch(std::move(Batch));
+            }
+        }
+    }
+
+    void Flush() {
+        FlushChunk();
+        if (!Batch.empty()) {
+            Executer.AddBatch(std::move(Batch));
+        }
+    }
+
+    ~TChunkedSubmitter() {
+        Flush();
+    }
+
+private:
+    void FlushChunk() {
+        if (Chunk.empty()) {
+            return;
+        }
+
+        Batch.push_back(CreateChunkedTask(std::move(Chunk), Func));
+        Chunk = std::vector<TItem>();
+        Chunk.reserve(ChunkSize);
+    }
+
+    IExecuter& Executer;
+    TFunc Func;
+    size_t ChunkSize;
+    size_t BatchSize;
+    std::vector<TItem> Chunk;
+    std::vector<TInlineTask> Batch;
+};
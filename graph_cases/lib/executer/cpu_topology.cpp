@@ -0,0 +1,149 @@
+#include "cpu_topology.h"
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    size_t ReadTopologyValue(size_t cpu, const std::string& name) {
+        std::ifstream in("/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/" + name);
+        long long value = 0;
+        if (!(in >> value) || value < 0) {
+            return 0;
+        }
+
+        return static_cast<size_t>(value);
+    }
+
+    std::vector<size_t> AllowedCpus() {
+        std::vector<size_t> result;
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            for (size_t cpu = 0; cpu != CPU_SETSIZE; ++cpu) {
+                if (CPU_ISSET(cpu, &set)) {
+                    result.push_back(cpu);
+                }
+            }
+        }
+#endif
+        return result;
+    }
+}
+
+EPinPolicy ParsePinPolicy(const std::string& name) {
+    if (name == "none") {
+        return EPinPolicy::None;
+    }
+
+    if (name == "compact") {
+        return EPinPolicy::Compact;
+    }
+
+    if (name == "spread") {
+        return EPinPolicy::Spread;
+    }
+
+    throw std::invalid_argument("unknown pin policy: " + name);
+}
+
+std::vector<TCpu> ReadCpuTopology() {
+    std::vector<TCpu> result;
+    for (auto id : AllowedCpus()) {
+        TCpu cpu;
+        cpu.Id = id;
+        cpu.Package = ReadTopologyValue(id, "physical_package_id");
+        cpu.Core = ReadTopologyValue(id, "core_id");
+        result.push_back(cpu);
+    }
+
+    return result;
+}
+
+std::vector<TCpu> PlanWorkerCpus(std::vector<TCpu> cpus, size_t threadCount, EPinPolicy policy) {
+    if (policy == EPinPolicy::None || cpus.empty()) {
+        return {};
+    }
+
+    // physical cores first, hyperthread siblings after them
+    std::map<std::pair<size_t, size_t>, size_t> siblings;
+    std::vector<std::pair<size_t, TCpu>> ranked;
+    for (const auto& cpu : cpus) {
+        ranked.emplace_back(siblings[{cpu.Package, cpu.Core}]++, cpu);
+    }
+
+    std::sort(ranked.begin(), ranked.end(), [](const auto& lhs, const auto& rhs) {
+        return std::make_tuple(lhs.second.Package, lhs.first, lhs.second.Core, lhs.second.Id)
+            < std::make_tuple(rhs.second.Package, rhs.first, rhs.second.Core, rhs.second.Id);
+    });
+
+    std::vector<TCpu> order;
+    if (policy == EPinPolicy::Compact) {
+        for (const auto& item : ranked) {
+            order.push_back(item.second);
+        }
+    } else {
+        std::map<size_t, std::vector<TCpu>> packages;
+        for (const auto& item : ranked) {
+            packages[item.second.Package].push_back(item.second);
+        }
+
+        for (size_t i = 0; order.size() != cpus.size(); ++i) {
+            for (const auto& package : packages) {
+                if (i < package.second.size()) {
+                    order.push_back(package.second[i]);
+                }
+            }
+        }
+    }
+
+    std::vector<TCpu> result;
+    for (size_t i = 0; i != threadCount; ++i) {
+        result.push_back(order[i % order.size()]);
+    }
+
+    return result;
+}
+
+bool PinCurrentThread(size_t cpu) {
+#ifdef __linux__
+    if (cpu >= CPU_SETSIZE) {
+        return false;
+    }
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+void PinWorker(const std::vector<TCpu>& layout, size_t workerIndex) {
+    if (workerIndex < layout.size()) {
+        PinCurrentThread(layout[workerIndex].Id);
+    }
+}
+
+void PrintWorkerLayout(std::ostream& out, const std::vector<TCpu>& layout) {
+    if (layout.empty()) {
+        out << "workers are not pinned" << std::endl;
+        return;
+    }
+
+    for (size_t i = 0; i != layout.size(); ++i) {
+        out << "worker " << i << ": cpu " << layout[i].Id << " package " << layout[i].Package << " core " << layout[i].Core << std::endl;
+    }
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+struct TCpu {
+    size_t Id = 0;
+    size_t Package = 0;
+    size_t Core = 0;
+};
+
+/*
+ * How workers are placed on cpus.
+ * Compact fills one package before moving to the next,
+ * Spread splits workers evenly between packages.
+ */
+enum class EPinPolicy {
+    None,
+    Compact,
+    Spread,
+};
+
+EPinPolicy ParsePinPolicy(const std::string& name);
+
+/*
+ * Cpus the process may run on, with package and core ids
+ * taken from /sys/devices/system/cpu (zero when unknown).
+ */
+std::vector<TCpu> ReadCpuTopology();
+
+/*
+ * Cpu for every worker, empty when the workers are not pinned.
+ * Workers wrap around when there are more of them than cpus.
+ */
+std::vector<TCpu> PlanWorkerCpus(std::vector<TCpu> cpus, size_t threadCount, EPinPolicy policy);
+
+bool PinCurrentThread(size_t cpu);
+
+// pins the worker if the layout has a cpu for it
+void PinWorker(const std::vector<TCpu>& layout, size_t workerIndex);
+
+void PrintWorkerLayout(std::ostream& out, const std::vector<TCpu>& layout);
@@ -1,14 +1,48 @@
 #include "executer.h"
 #include "multithread_executer.h"
 #include "singlethread_exectuer.h"
+#include "work_stealing_executer.h"
 
 #include "queue/queue.h"
 
+#include <utility>
 
-std::unique_ptr<IExecuter> CreateExecuter(size_t threadCount, size_t maxSize, TMultiThreadQueue<std::exception_ptr>* e) {
-    if (threadCount == 1) {
-       return std::make_unique<TSingleThreadExecuter>();
+
+std::unique_ptr<IExecuter> CreateExecuter(const TExecuterOptions& options) {
+    std::unique_ptr<TExecuterMetrics> metrics;
+    if (options.CollectMetrics) {
+        size_t workerCount = options.ThreadCount <= 1 ? 0 : options.ThreadCount;
+        metrics = std::make_unique<TExecuterMetrics>(workerCount, options.MetricsReport);
+    }
+
+    if (options.ThreadCount <= 1) {
+       return std::make_unique<TSingleThreadExecuter>(std::move(metrics));
+    }
+
+    std::vector<TCpu> layout;
+    if (options.Pinning != EPinPolicy::None) {
+        layout = PlanWorkerCpus(ReadCpuTopology(), options.ThreadCount, options.Pinning);
+    }
+
+    if (options.LayoutReport) {
+        PrintWorkerLayout(*options.LayoutReport, layout);
+    }
+
+    if (options.WorkStealing) {
+        return std::make_unique<TWorkStealingExecuter>(options.ThreadCount, options.MaxQueueSize, options.Exceptions, std::move(layout), std::move(metrics));
     }
 
-    return std::make_unique<TMultiThreadExecuter>(threadCount, maxSize, e);
+    if (options.LockFreeQueue) {
+        return std::make_unique<TLockFreeMultiThreadExecuter>(options.ThreadCount, options.MaxQueueSize, options.Exceptions, options.PopBatchSize, std::move(layout), std::move(metrics));
+    }
+
+    return std::make_unique<TMultiThreadExecuter>(options.ThreadCount, options.MaxQueueSize, options.Exceptions, options.PopBatchSize, std::move(layout), std::move(metrics));
+}
+
+std::unique_ptr<IExecuter> CreateExecuter(size_t threadCount, size_t maxSize, TMultiThreadQueue<std::exception_ptr>* e) {
+    TExecuterOptions options;
+    options.ThreadCount = threadCount;
+    options.MaxQueueSize = maxSize;
+    options.Exceptions = e;
+    return CreateExecuter(options);
 }
\ No newline at end of file
@@ -1,9 +1,15 @@
 #pragma once
 
+#include "cancellation.h"
+#include "cpu_topology.h"
+#include "executer_metrics.h"
+#include "inline_task.h"
 #include "queue/queue.h"
 
 #include <memory>
 #include <exception>
+#include <ostream>
+#include <vector>
 
 class ITask {
 public:
@@ -14,16 +20,82 @@ public:
 
 class IExecuter {
 public:
-    virtual void Add(std::unique_ptr<ITask> &&task) = 0;
+    virtual void Add(TInlineTask&& task) = 0;
+
+    void Add(std::unique_ptr<ITask>&& task) {
+        Add(TInlineTask([task = std::move(task)]() {
+            task->Do();
+        }));
+    }
+
+    // Adds all the tasks at once, implementations may take one lock for the whole batch
+    virtual void AddBatch(std::vector<TInlineTask>&& tasks) {
+        for (auto& task : tasks) {
+            Add(std::move(task));
+        }
+
+        tasks.clear();
+    }
 
     virtual void Stop() = 0;
 
     virtual size_t Size() = 0;
 
+    // number of worker threads, tasks of a single-threaded executer run on the caller
+    virtual size_t ThreadCount() const = 0;
+
+    // null when the executer does not collect metrics
+    virtual const TExecuterMetrics* Metrics() const {
+        return nullptr;
+    }
+
+    void DumpMetrics(std::ostream& out) const {
+        if (auto metrics = Metrics()) {
+            metrics->Dump(out);
+        } else {
+            out << "metrics are not collected" << std::endl;
+        }
+    }
+
+    // queued and later added tasks are dropped, running tasks may poll the token to stop early
+    void Cancel() {
+        Cancellation->Cancel();
+    }
+
+    bool IsCancelled() const {
+        return Cancellation->IsCancelled();
+    }
+
+    const std::shared_ptr<TCancellationToken>& CancellationToken() const {
+        return Cancellation;
+    }
+
     virtual ~IExecuter() = default;
 
+private:
+    std::shared_ptr<TCancellationToken> Cancellation = std::make_shared<TCancellationToken>();
 };
 
+struct TExecuterOptions {
+    size_t ThreadCount = 1;
+    size_t MaxQueueSize = 0;
+    TMultiThreadQueue<std::exception_ptr>* Exceptions = nullptr;
+    bool WorkStealing = false;
+    // use the lock-free ring instead of the mutex-guarded queue
+    bool LockFreeQueue = false;
+    // how many tasks a worker of the shared queue takes per lock acquisition
+    size_t PopBatchSize = 1;
+    EPinPolicy Pinning = EPinPolicy::None;
+    // where to print the worker placement, nothing is printed when null
+    std::ostream* LayoutReport = nullptr;
+    // time tasks, workers and producers, see TExecuterMetrics
+    bool CollectMetrics = false;
+    // where to print the metrics at Stop, nothing is printed when null
+    std::ostream* MetricsReport = nullptr;
+};
+
+std::unique_ptr<IExecuter> CreateExecuter(const TExecuterOptions& options);
+
 std::unique_ptr<IExecuter> CreateExecuter(size_t threadCount, size_t maxSize, TMultiThreadQueue<std::exception_ptr>* e);
 
 template<typename TFunc>
@@ -43,6 +115,6 @@ private:
 };
 
 template<typename F>
-std::unique_ptr<ITask> CreateTask(F&& f) {
-    return std::make_unique<TFunctionTask<F>>(std::move(f));
+TInlineTask CreateTask(F&& f) {
+    return TInlineTask(std::move(f));
 }
\ No newline at end of file
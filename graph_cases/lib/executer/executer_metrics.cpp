@@ -0,0 +1,96 @@
+#include "executer_metrics.h"
+
+#include <cmath>
+
+namespace {
+    uint64_t Nanoseconds(TMetricsClock::time_point begin, TMetricsClock::time_point end) {
+        if (end <= begin) {
+            return 0;
+        }
+
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count());
+    }
+
+    void PrintHistogram(std::ostream& out, const char* name, const TLogLinearHistogram& histogram) {
+        out << name << " (us):"
+            << " count " << histogram.Count()
+            << " mean " << histogram.Mean() / 1000
+            << " p50 " << histogram.Quantile(0.5) / 1000.0
+            << " p90 " << histogram.Quantile(0.9) / 1000.0
+            << " p99 " << histogram.Quantile(0.99) / 1000.0
+            << " max " << histogram.Max() / 1000.0
+            << std::endl;
+    }
+}
+
+TExecuterMetrics::TExecuterMetrics(size_t workerCount, std::ostream* report)
+    : Workers{}
+    , Report(report)
+    , Reported(false)
+{
+    for (size_t i = 0; i != workerCount; ++i) {
+        Workers.push_back(std::make_unique<TWorkerTimes>());
+    }
+}
+
+void TExecuterMetrics::OnAdd(TMetricsClock::time_point begin, TMetricsClock::time_point end) {
+    AddTime_.Record(Nanoseconds(begin, end));
+}
+
+void TExecuterMetrics::OnIdle(size_t worker, TMetricsClock::time_point begin, TMetricsClock::time_point end) {
+    if (worker < Workers.size()) {
+        Workers[worker]->IdleNs.fetch_add(Nanoseconds(begin, end), std::memory_order_relaxed);
+    }
+}
+
+void TExecuterMetrics::OnTask(size_t worker, TMetricsClock::time_point enqueued, TMetricsClock::time_point started, TMetricsClock::time_point finished) {
+    uint64_t busy = Nanoseconds(started, finished);
+    QueueWait_.Record(Nanoseconds(enqueued, started));
+    Execution_.Record(busy);
+    if (worker < Workers.size()) {
+        Workers[worker]->Tasks.fetch_add(1, std::memory_order_relaxed);
+        Workers[worker]->BusyNs.fetch_add(busy, std::memory_order_relaxed);
+    }
+}
+
+void TExecuterMetrics::OnStop() {
+    if (Report && !Reported.exchange(true)) {
+        Dump(*Report);
+    }
+}
+
+void TExecuterMetrics::Dump(std::ostream& out) const {
+    PrintHistogram(out, "queue wait", QueueWait_);
+    PrintHistogram(out, "execution", Execution_);
+    PrintHistogram(out, "add", AddTime_);
+    for (size_t i = 0; i != Workers.size(); ++i) {
+        uint64_t busy = Workers[i]->BusyNs.load(std::memory_order_relaxed);
+        uint64_t idle = Workers[i]->IdleNs.load(std::memory_order_relaxed);
+        double utilization = (busy + idle == 0) ? 0.0 : 100.0 * busy / (busy + idle);
+        out << "worker " << i << ":"
+            << " tasks " << Workers[i]->Tasks.load(std::memory_order_relaxed)
+            << " busy " << busy / 1000000.0 << " ms"
+            << " idle " << idle / 1000000.0 << " ms"
+            << " utilization " << std::round(utilization * 10) / 10 << "%"
+            << std::endl;
+    }
+}
+
+void RunQueuedTask(TQueuedTask& task, const TCancellationToken& cancellation, TExecuterMetrics* metrics, size_t worker, TMultiThreadQueue<std::exception_ptr>* exceptions) {
+    if (cancellation.IsCancelled()) {
+        return;
+    }
+
+    auto started = metrics ? TExecuterMetrics::Now() : TMetricsClock::time_point{};
+    try {
+        task.Task();
+    } catch (...) {
+        if (exceptions) {
+            exceptions->Push(std::current_exception());
+        }
+    }
+
+    if (metrics) {
+        metrics->OnTask(worker, task.Enqueued, started, TExecuterMetrics::Now());
+    }
+}
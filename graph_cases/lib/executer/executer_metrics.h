@@ -0,0 +1,80 @@
+#pragma once
+
+#include "cancellation.h"
+#include "histogram.h"
+#include "inline_task.h"
+#include "queue/queue.h"
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+using TMetricsClock = std::chrono::steady_clock;
+
+// a task with the moment it was handed to the executer
+struct TQueuedTask {
+    TInlineTask Task;
+    TMetricsClock::time_point Enqueued{};
+};
+
+/*
+ * Timings of an executer: queue wait and execution time of every task,
+ * time producers spend in Add, busy and idle time of every worker.
+ * Workers and producers update it concurrently without locks,
+ * Dump() may be called at any moment.
+ */
+class TExecuterMetrics {
+public:
+    // the metrics are printed to report on the first OnStop(), if it is not null
+    TExecuterMetrics(size_t workerCount, std::ostream* report);
+
+    static TMetricsClock::time_point Now() {
+        return TMetricsClock::now();
+    }
+
+    void OnAdd(TMetricsClock::time_point begin, TMetricsClock::time_point end);
+
+    void OnIdle(size_t worker, TMetricsClock::time_point begin, TMetricsClock::time_point end);
+
+    void OnTask(size_t worker, TMetricsClock::time_point enqueued, TMetricsClock::time_point started, TMetricsClock::time_point finished);
+
+    void OnStop();
+
+    void Dump(std::ostream& out) const;
+
+    const TLogLinearHistogram& QueueWait() const {
+        return QueueWait_;
+    }
+
+    const TLogLinearHistogram& Execution() const {
+        return Execution_;
+    }
+
+    const TLogLinearHistogram& AddTime() const {
+        return AddTime_;
+    }
+
+private:
+    struct alignas(64) TWorkerTimes {
+        std::atomic<uint64_t> Tasks{0};
+        std::atomic<uint64_t> BusyNs{0};
+        std::atomic<uint64_t> IdleNs{0};
+    };
+
+    TLogLinearHistogram QueueWait_;
+    TLogLinearHistogram Execution_;
+    TLogLinearHistogram AddTime_;
+    std::vector<std::unique_ptr<TWorkerTimes>> Workers;
+    std::ostream* Report;
+    std::atomic<bool> Reported;
+};
+
+/*
+ * Runs a task taken from a queue unless the executer is cancelled,
+ * exceptions go to the exceptions queue.
+ * Queue wait and execution time are recorded when metrics are collected.
+ */
+void RunQueuedTask(TQueuedTask& task, const TCancellationToken& cancellation, TExecuterMetrics* metrics, size_t worker, TMultiThreadQueue<std::exception_ptr>* exceptions);
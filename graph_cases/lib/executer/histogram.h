@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * Lock-free log-linear histogram of non-negative values.
+ * Every power of two is split into 8 linear buckets, so a bucket bound
+ * is within 12.5% of any value in it. Recording is a few relaxed atomic
+ * increments and may race freely with readers.
+ */
+class TLogLinearHistogram {
+public:
+    static constexpr size_t SubBucketBits = 3;
+    static constexpr size_t SubBucketCount = size_t{1} << SubBucketBits;
+    static constexpr size_t BucketCount = (64 - SubBucketBits + 1) * SubBucketCount;
+
+    TLogLinearHistogram()
+        : Buckets{}
+        , Count_(0)
+        , Sum_(0)
+        , Max_(0)
+    {
+    }
+
+    void Record(uint64_t value) {
+        Buckets[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+        Count_.fetch_add(1, std::memory_order_relaxed);
+        Sum_.fetch_add(value, std::memory_order_relaxed);
+        uint64_t max = Max_.load(std::memory_order_relaxed);
+        while (max < value && !Max_.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    uint64_t Count() const {
+        return Count_.load(std::memory_order_relaxed);
+    }
+
+    uint64_t Sum() const {
+        return Sum_.load(std::memory_order_relaxed);
+    }
+
+    uint64_t Max() const {
+        return Max_.load(std::memory_order_relaxed);
+    }
+
+    double Mean() const {
+        uint64_t count = Count();
+        return count == 0 ? 0.0 : static_cast<double>(Sum()) / count;
+    }
+
+    // upper bound of the bucket holding the q-th quantile
+    uint64_t Quantile(double q) const {
+        uint64_t count = Count();
+        if (count == 0) {
+            return 0;
+        }
+
+        uint64_t rank = static_cast<uint64_t>(q * count);
+        if (rank >= count) {
+            rank = count - 1;
+        }
+
+        uint64_t seen = 0;
+        for (size_t i = 0; i != BucketCount; ++i) {
+            seen += Buckets[i].load(std::memory_order_relaxed);
+            if (seen > rank) {
+                return BucketUpperBound(i);
+            }
+        }
+
+        return Max();
+    }
+
+    static size_t BucketIndex(uint64_t value) {
+        if (value < SubBucketCount) {
+            return static_cast<size_t>(value);
+        }
+
+        size_t exponent = 63 - __builtin_clzll(value);
+        size_t subBucket = (value >> (exponent - SubBucketBits)) & (SubBucketCount - 1);
+        return (exponent - SubBucketBits + 1) * SubBucketCount + subBucket;
+    }
+
+    static uint64_t BucketUpperBound(size_t index) {
+        if (index < SubBucketCount) {
+            return index;
+        }
+
+        size_t shift = index / SubBucketCount - 1;
+        uint64_t lower = (SubBucketCount + index % SubBucketCount) << shift;
+        return lower + ((uint64_t{1} << shift) - 1);
+    }
+
+private:
+    std::atomic<uint64_t> Buckets[BucketCount];
+    std::atomic<uint64_t> Count_;
+    std::atomic<uint64_t> Sum_;
+    std::atomic<uint64_t> Max_;
+};
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/*
+ * Move-only nullary callable with a small inline buffer.
+ * Callables up to InlineSize bytes which are nothrow movable are stored
+ * in place and never touch the allocator, bigger ones are kept on the heap.
+ */
+class TInlineTask {
+public:
+    static constexpr size_t InlineSize = 64;
+
+    TInlineTask() noexcept
+        : Ops(nullptr)
+    {
+    }
+
+    template<typename TFunc, typename = std::enable_if_t<
+        !std::is_same_v<std::decay_t<TFunc>, TInlineTask> && std::is_invocable_v<std::decay_t<TFunc>&>>>
+    TInlineTask(TFunc&& func)
+        : Ops(nullptr)
+    {
+        using TStored = std::decay_t<TFunc>;
+        if constexpr (IsInlined<TStored>()) {
+            new (Buffer) TStored(std::forward<TFunc>(func));
+            Ops = &InlineOps<TStored>;
+        } else {
+            new (Buffer) TStored*(new TStored(std::forward<TFunc>(func)));
+            Ops = &HeapOps<TStored>;
+        }
+    }
+
+    TInlineTask(TInlineTask&& other) noexcept
+        : Ops(other.Ops)
+    {
+        if (Ops) {
+            Ops->Move(other.Buffer, Buffer);
+            other.Ops = nullptr;
+        }
+    }
+
+    TInlineTask& operator=(TInlineTask&& other) noexcept {
+        if (this != &other) {
+            Reset();
+            Ops = other.Ops;
+            if (Ops) {
+                Ops->Move(other.Buffer, Buffer);
+                other.Ops = nullptr;
+            }
+        }
+
+        return *this;
+    }
+
+    TInlineTask(const TInlineTask&) = delete;
+
+    TInlineTask& operator=(const TInlineTask&) = delete;
+
+    ~TInlineTask() {
+        Reset();
+    }
+
+    void operator()() {
+        Ops->Invoke(Buffer);
+    }
+
+    explicit operator bool() const noexcept {
+        return Ops != nullptr;
+    }
+
+    bool IsInline() const noexcept {
+        return Ops != nullptr && Ops->Inline;
+    }
+
+    template<typename TFunc>
+    static constexpr bool IsInlined() {
+        return sizeof(TFunc) <= InlineSize && alignof(TFunc) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible_v<TFunc>;
+    }
+
+private:
+    struct TOps {
+        void (*Invoke)(void* buffer);
+        // moves the callable into the destination, the source is left empty
+        void (*Move)(void* source, void* destination) noexcept;
+        void (*Destroy)(void* buffer) noexcept;
+        bool Inline;
+    };
+
+    template<typename TFunc>
+    static constexpr TOps InlineOps = {
+        [](void* buffer) {
+            (*static_cast<TFunc*>(buffer))();
+        },
+        [](void* source, void* destination) noexcept {
+            new (destination) TFunc(std::move(*static_cast<TFunc*>(source)));
+            static_cast<TFunc*>(source)->~TFunc();
+        },
+        [](void* buffer) noexcept {
+            static_cast<TFunc*>(buffer)->~TFunc();
+        },
+        true,
+    };
+
+    template<typename TFunc>
+    static constexpr TOps HeapOps = {
+        [](void* buffer) {
+            (**static_cast<TFunc**>(buffer))();
+        },
+        [](void* source, void* destination) noexcept {
+            new (destination) TFunc*(*static_cast<TFunc**>(source));
+        },
+        [](void* buffer) noexcept {
+            delete *static_cast<TFunc**>(buffer);
+        },
+        false,
+    };
+
+    void Reset() noexcept {
+        if (Ops) {
+            Ops->Destroy(Buffer);
+            Ops = nullptr;
+        }
+    }
+
+    alignas(std::max_align_t) unsigned char Buffer[InlineSize];
+    const TOps* Ops;
+};
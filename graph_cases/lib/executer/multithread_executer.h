@@ -1,32 +1,168 @@
+#pragma once
+
+#include "cpu_topology.h"
 #include "executer.h"
+#include "executer_metrics.h"
+#include "worker_index.h"
+
+#include "queue/lock_free_queue.h"
+#include "queue/queue.h"
 
+#include <algorithm>
+#include <atomic>
 #include <exception>
+#include <memory>
 #include <thread>
+#include <utility>
 #include <variant>
 #include <vector>
 
 struct TStopMessage {};
 
-class TMultiThreadExecuter : public IExecuter {
+/*
+ * Executer with a pool of workers taking tasks from one shared queue.
+ * The queue type is a template parameter: TMultiThreadQueue or TLockFreeQueue.
+ */
+template<template<typename> class TQueue>
+class TBasicMultiThreadExecuter : public IExecuter {
 public:
-    explicit TMultiThreadExecuter(size_t theadCount, size_t queueSize, TMultiThreadQueue<std::exception_ptr>* exceptions);
+    explicit TBasicMultiThreadExecuter(size_t threadCount, size_t queueSize, TMultiThreadQueue<std::exception_ptr>* exceptions, size_t popBatchSize = 1, std::vector<TCpu> layout = {}, std::unique_ptr<TExecuterMetrics> metrics = nullptr)
+        : Queue{queueSize}
+        , Threads{}
+        , Exceptions(exceptions)
+        , PopBatchSize(std::max<size_t>(popBatchSize, 1))
+        , AliveThreads(threadCount)
+        , Layout(std::move(layout))
+        , Metrics_(std::move(metrics))
+    {
+        for (size_t i = 0; i != threadCount; ++i) {
+            Threads.emplace_back([this, i](){
+                PinWorker(Layout, i);
+                SetCurrentWorker(this, i);
+                WorkerLoop(i);
+            });
+        }
+    }
+
+    using IExecuter::Add;
+
+    void Add(TInlineTask&& task) override {
+        if (IsCancelled()) {
+            return;
+        }
+
+        if (!Metrics_) {
+            Queue.Push(TItem(TQueuedTask{std::move(task)}));
+            return;
+        }
+
+        auto begin = TExecuterMetrics::Now();
+        Queue.Push(TItem(TQueuedTask{std::move(task), begin}));
+        Metrics_->OnAdd(begin, TExecuterMetrics::Now());
+    }
+
+    void AddBatch(std::vector<TInlineTask>&& tasks) override {
+        if (IsCancelled()) {
+            tasks.clear();
+            return;
+        }
+
+        auto begin = Metrics_ ? TExecuterMetrics::Now() : TMetricsClock::time_point{};
+        std::vector<TItem> items;
+        items.reserve(tasks.size());
+        for (auto& task : tasks) {
+            items.emplace_back(TQueuedTask{std::move(task), begin});
+        }
+
+        tasks.clear();
+        Queue.PushMany(std::move(items));
+        if (Metrics_) {
+            Metrics_->OnAdd(begin, TExecuterMetrics::Now());
+        }
+    }
 
-    void Add(std::unique_ptr<ITask>&& task) override;
+    size_t Size() override {
+        return Queue.Size();
+    }
 
-    size_t Size() override;
+    size_t ThreadCount() const override {
+        return Threads.size();
+    }
 
-    void Stop() override;
+    const TExecuterMetrics* Metrics() const override {
+        return Metrics_.get();
+    }
 
-    ~TMultiThreadExecuter() override;
+    void Stop() override {
+        StopAll();
+        WaitAll();
+        if (Metrics_) {
+            Metrics_->OnStop();
+        }
+    }
+
+    ~TBasicMultiThreadExecuter() override {
+        Stop();
+    }
 
 private:
-    void StopAll();
+    using TItem = std::variant<TStopMessage, TQueuedTask>;
+
+    void WorkerLoop(size_t workerIndex) {
+        const auto& cancellation = *CancellationToken();
+        std::vector<TItem> items;
+        items.reserve(PopBatchSize);
+        while (true) {
+            items.clear();
+            auto idleBegin = Metrics_ ? TExecuterMetrics::Now() : TMetricsClock::time_point{};
+            Queue.PopMany(items, PopBatchSize);
+            if (Metrics_) {
+                Metrics_->OnIdle(workerIndex, idleBegin, TExecuterMetrics::Now());
+            }
+
+            for (auto& item : items) {
+                if (item.index() == 0) {
+                    // the stop message goes further until every worker has seen it
+                    if (AliveThreads.fetch_sub(1) != 1) {
+                        Queue.Push(TItem(TStopMessage()));
+                    }
+                    return;
+                }
+
+                RunQueuedTask(std::get<TQueuedTask>(item), cancellation, Metrics_.get(), workerIndex, Exceptions);
+            }
+        }
+    }
 
-    void WaitAll();
+    void StopAll() {
+        if (!Threads.empty() && !StopSent) {
+            StopSent = true;
+            Queue.Push(TItem(TStopMessage()));
+        }
+    }
 
-    using TItem = std::variant<TStopMessage, std::unique_ptr<ITask>>;
-    TMultiThreadQueue<TItem> Queue;
+    void WaitAll() {
+        for (auto& thread : Threads) {
+            if (thread.joinable()) {
+                thread.join();
+            }
+        }
+    }
+
+    TQueue<TItem> Queue;
     std::vector<std::thread> Threads;
     TMultiThreadQueue<std::exception_ptr>* Exceptions;
+    size_t PopBatchSize;
+    std::atomic<size_t> AliveThreads;
+    bool StopSent = false;
+    const std::vector<TCpu> Layout;
+    std::unique_ptr<TExecuterMetrics> Metrics_;
 };
 
+using TMultiThreadExecuter = TBasicMultiThreadExecuter<TMultiThreadQueue>;
+
+using TLockFreeMultiThreadExecuter = TBasicMultiThreadExecuter<TLockFreeQueue>;
+
+extern template class TBasicMultiThreadExecuter<TMultiThreadQueue>;
+
+extern template class TBasicMultiThreadExecuter<TLockFreeQueue>;
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "executer.h"
+#include "worker_index.h"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+/*
+ * Per-thread accumulators for a parallel reduce.
+ * Every worker of the owning executer updates its own slot through Local() without any locking.
+ * A slot is allocated by its thread on first use, so it is padded to a cache line
+ * and lives on the memory node of the (pinned) worker.
+ * The last slot belongs to a single thread that is not a worker of the owner (the producer,
+ * or the caller of a single-threaded executer), Local() throws std::logic_error
+ * when a second such thread (e.g. a worker of another executer) calls it.
+ * Reduce() folds the slots and must be called after the tasks are finished,
+ * e.g. after IExecuter::Stop().
+ */
+template<typename T>
+class TParallelReducer {
+public:
+    // without an owner every slot but the last one is unused
+    TParallelReducer(const IExecuter* owner, const T& init)
+        : Owner(owner)
+        , Init(init)
+        , Slots((owner ? owner->ThreadCount() : 0) + 1)
+        , OtherThread{}
+    {
+    }
+
+    TParallelReducer(const IExecuter& executer, const T& init)
+        : TParallelReducer(&executer, init)
+    {
+    }
+
+    T& Local() {
+        size_t index = CurrentWorkerIndex(Owner);
+        if (index >= Slots.size() - 1) {
+            index = Slots.size() - 1;
+            CheckOtherThread();
+        }
+
+        auto& slot = Slots[index];
+        if (!slot) {
+            slot = std::make_unique<TSlot>(TSlot{Init});
+        }
+
+        return slot->Value;
+    }
+
+    // merge(accumulator, slot) folds every used slot into a copy of the initial value
+    template<typename TMerge>
+    T Reduce(TMerge&& merge) const {
+        T result = Init;
+        for (const auto& slot : Slots) {
+            if (slot) {
+                merge(result, slot->Value);
+            }
+        }
+
+        return result;
+    }
+
+    // visits every used slot, must not race with Local()
+    template<typename TFunc>
+    void ForEachLocal(TFunc&& func) {
+        for (auto& slot : Slots) {
+            if (slot) {
+                func(slot->Value);
+            }
+        }
+    }
+
+    size_t SlotCount() const {
+        return Slots.size();
+    }
+
+private:
+    struct alignas(64) TSlot {
+        T Value;
+    };
+
+    void CheckOtherThread() {
+        auto self = std::this_thread::get_id();
+        if (OtherThread.load(std::memory_order_relaxed) == self) {
+            return;
+        }
+
+        std::thread::id expected{};
+        if (!OtherThread.compare_exchange_strong(expected, self) && expected != self) {
+            throw std::logic_error("the shared slot of a parallel reducer is used by two threads which are not its workers");
+        }
+    }
+
+    const IExecuter* Owner;
+    const T Init;
+    std::vector<std::unique_ptr<TSlot>> Slots;
+    std::atomic<std::thread::id> OtherThread;
+};
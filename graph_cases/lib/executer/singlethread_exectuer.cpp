@@ -1,14 +1,55 @@
 #include "singlethread_exectuer.h"
+#include "worker_index.h"
 
-void TSingleThreadExecuter::Add(std::unique_ptr<ITask>&& task) {
-    task->Do();
+#include <utility>
+
+TSingleThreadExecuter::TSingleThreadExecuter(std::unique_ptr<TExecuterMetrics> metrics)
+    : Metrics_(std::move(metrics))
+{
 }
 
-void TSingleThreadExecuter::Stop() {
+void TSingleThreadExecuter::Add(TInlineTask&& task) {
+    Run(task);
+}
+
+void TSingleThreadExecuter::AddBatch(std::vector<TInlineTask>&& tasks) {
+    for (auto& task : tasks) {
+        Run(task);
+    }
+
+    tasks.clear();
+}
+
+void TSingleThreadExecuter::Run(TInlineTask& task) {
+    if (IsCancelled()) {
+        return;
+    }
+
+    if (!Metrics_) {
+        task();
+        return;
+    }
 
+    // the task runs on the caller right away, so it never waits in a queue
+    auto started = TExecuterMetrics::Now();
+    task();
+    Metrics_->OnTask(NoWorkerIndex, started, started, TExecuterMetrics::Now());
+}
+
+void TSingleThreadExecuter::Stop() {
+    if (Metrics_) {
+        Metrics_->OnStop();
+    }
 }
 
 size_t TSingleThreadExecuter::Size() {
     return 0;
 }
 
+size_t TSingleThreadExecuter::ThreadCount() const {
+    return 0;
+}
+
+const TExecuterMetrics* TSingleThreadExecuter::Metrics() const {
+    return Metrics_.get();
+}
@@ -1,18 +1,34 @@
 #pragma once
 
 #include "executer.h"
+#include "executer_metrics.h"
 
 #include <memory>
 
 class TSingleThreadExecuter : public IExecuter {
 public:
-    void Add(std::unique_ptr<ITask>&& task) override;
+    explicit TSingleThreadExecuter(std::unique_ptr<TExecuterMetrics> metrics = nullptr);
+
+    using IExecuter::Add;
+
+    void Add(TInlineTask&& task) override;
+
+    void AddBatch(std::vector<TInlineTask>&& tasks) override;
 
     void Stop() override;
 
     size_t Size() override;
 
+    size_t ThreadCount() const override;
+
+    const TExecuterMetrics* Metrics() const override;
+
     virtual ~TSingleThreadExecuter() = default;
+
+private:
+    void Run(TInlineTask& task);
+
+    std::unique_ptr<TExecuterMetrics> Metrics_;
 };
 
 
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/*
+ * Chase-Lev work-stealing deque.
+ * One owner thread pushes and pops items at the bottom (LIFO), any number of threads
+ * steal them from the top (FIFO). Successive owners must be synchronized externally.
+ * The storage grows when full, retired arrays are kept until destruction
+ * because a concurrent thief may still read from them.
+ * TItem should be trivially copyable (e.g. a pointer).
+ */
+template<typename TItem>
+class TWorkStealingDeque {
+public:
+    explicit TWorkStealingDeque(size_t capacity = 256)
+        : Top(0)
+        , Bottom(0)
+        , Array(nullptr)
+    {
+        size_t realCapacity = 1;
+        while (realCapacity < capacity) {
+            realCapacity <<= 1;
+        }
+
+        Arrays.push_back(std::make_unique<TArray>(realCapacity));
+        Array.store(Arrays.back().get(), std::memory_order_relaxed);
+    }
+
+    void Push(TItem item) {
+        int64_t bottom = Bottom.load(std::memory_order_relaxed);
+        int64_t top = Top.load(std::memory_order_acquire);
+        TArray* array = Array.load(std::memory_order_relaxed);
+        if (bottom - top > static_cast<int64_t>(array->Capacity) - 1) {
+            array = Grow(array, top, bottom);
+        }
+
+        array->Put(bottom, item);
+        Bottom.store(bottom + 1, std::memory_order_release);
+    }
+
+    // owner only, the last item races with thieves only when it is the single one left
+    bool Pop(TItem& result) {
+        int64_t bottom = Bottom.load(std::memory_order_relaxed) - 1;
+        TArray* array = Array.load(std::memory_order_relaxed);
+        Bottom.store(bottom, std::memory_order_seq_cst);
+        int64_t top = Top.load(std::memory_order_seq_cst);
+        if (top > bottom) {
+            Bottom.store(bottom + 1, std::memory_order_relaxed);
+            return false;
+        }
+
+        TItem item = array->Get(bottom);
+        if (top == bottom) {
+            bool won = Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            Bottom.store(bottom + 1, std::memory_order_relaxed);
+            if (!won) {
+                return false;
+            }
+        }
+
+        result = item;
+        return true;
+    }
+
+    bool Steal(TItem& result) {
+        while (true) {
+            int64_t top = Top.load(std::memory_order_seq_cst);
+            int64_t bottom = Bottom.load(std::memory_order_seq_cst);
+            if (top >= bottom) {
+                return false;
+            }
+
+            TArray* array = Array.load(std::memory_order_acquire);
+            TItem item = array->Get(top);
+            if (Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                result = item;
+                return true;
+            }
+        }
+    }
+
+    size_t Size() const {
+        int64_t bottom = Bottom.load(std::memory_order_relaxed);
+        int64_t top = Top.load(std::memory_order_relaxed);
+        return bottom > top ? static_cast<size_t>(bottom - top) : 0;
+    }
+
+private:
+    struct TArray {
+        size_t Capacity;
+        std::unique_ptr<std::atomic<TItem>[]> Items;
+
+        explicit TArray(size_t capacity)
+            : Capacity(capacity)
+            , Items(new std::atomic<TItem>[capacity])
+        {
+        }
+
+        TItem Get(int64_t index) const {
+            return Items[index & (Capacity - 1)].load(std::memory_order_relaxed);
+        }
+
+        void Put(int64_t index, TItem item) {
+            Items[index & (Capacity - 1)].store(item, std::memory_order_relaxed);
+        }
+    };
+
+    TArray* Grow(TArray* array, int64_t top, int64_t bottom) {
+        auto newArray = std::make_unique<TArray>(array->Capacity * 2);
+        for (int64_t i = top; i != bottom; ++i) {
+            newArray->Put(i, array->Get(i));
+        }
+
+        Arrays.push_back(std::move(newArray));
+        TArray* result = Arrays.back().get();
+        Array.store(result, std::memory_order_release);
+        return result;
+    }
+
+    alignas(64) std::atomic<int64_t> Top;
+    alignas(64) std::atomic<int64_t> Bottom;
+    std::atomic<TArray*> Array;
+    std::vector<std::unique_ptr<TArray>> Arrays;
+};
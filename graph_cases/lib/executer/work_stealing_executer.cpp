@@ -0,0 +1,264 @@
+#include "work_stealing_executer.h"
+#include "worker_index.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+    constexpr size_t SpinCount = 64;
+
+    // the most injected tasks a worker moves to its deque at once
+    constexpr size_t MaxInjectedBatch = 32;
+}
+
+TWorkStealingExecuter::TWorkStealingExecuter(size_t threadCount, size_t maxSize, TMultiThreadQueue<std::exception_ptr>* exceptions, std::vector<TCpu> layout, std::unique_ptr<TExecuterMetrics> metrics)
+    : Deques{}
+    , Threads{}
+    , Exceptions(exceptions)
+    , MaxSize(maxSize)
+    , Layout(std::move(layout))
+    , Metrics_(std::move(metrics))
+    , InjectedSize(0)
+    , Pending(0)
+    , Sleeping(0)
+    , ProducerBlocked(false)
+    , Stopping(false)
+{
+    for (size_t i = 0; i != threadCount; ++i) {
+        Deques.push_back(std::make_unique<TWorkStealingDeque<TQueuedTask*>>());
+    }
+
+    for (size_t i = 0; i != threadCount; ++i) {
+        Threads.emplace_back([this, i]() {
+            PinWorker(Layout, i);
+            SetCurrentWorker(this, i);
+            WorkerLoop(i);
+        });
+    }
+}
+
+void TWorkStealingExecuter::Add(TInlineTask&& task) {
+    if (IsCancelled()) {
+        return;
+    }
+
+    auto begin = Metrics_ ? TExecuterMetrics::Now() : TMetricsClock::time_point{};
+    if (size_t worker = CurrentWorkerIndex(this); worker != NoWorkerIndex) {
+        // a worker never waits for space, nobody might be left to make it
+        Deques[worker]->Push(new TQueuedTask{std::move(task), begin});
+        Pending.fetch_add(1);
+    } else {
+        std::lock_guard<std::mutex> lock(AddMutex);
+        PushLocked(std::move(task), begin);
+    }
+
+    NotifyWorkers(1);
+    if (Metrics_) {
+        Metrics_->OnAdd(begin, TExecuterMetrics::Now());
+    }
+}
+
+void TWorkStealingExecuter::AddBatch(std::vector<TInlineTask>&& tasks) {
+    if (IsCancelled()) {
+        tasks.clear();
+        return;
+    }
+
+    auto begin = Metrics_ ? TExecuterMetrics::Now() : TMetricsClock::time_point{};
+    size_t added = 0;
+    if (size_t worker = CurrentWorkerIndex(this); worker != NoWorkerIndex) {
+        auto& deque = *Deques[worker];
+        for (auto& task : tasks) {
+            deque.Push(new TQueuedTask{std::move(task), begin});
+            Pending.fetch_add(1);
+            ++added;
+        }
+    } else {
+        std::lock_guard<std::mutex> lock(AddMutex);
+        for (auto& task : tasks) {
+            PushLocked(std::move(task), begin);
+            ++added;
+        }
+    }
+
+    tasks.clear();
+    NotifyWorkers(added);
+    if (Metrics_) {
+        Metrics_->OnAdd(begin, TExecuterMetrics::Now());
+    }
+}
+
+void TWorkStealingExecuter::PushLocked(TInlineTask&& task, TMetricsClock::time_point enqueued) {
+    if (MaxSize != 0) {
+        WaitForSpace();
+    }
+
+    // deque slots are stolen by plain loads, so the task itself is boxed
+    auto* queued = new TQueuedTask{std::move(task), enqueued};
+    std::lock_guard<std::mutex> lock(InjectMutex);
+    Injected.push_back(queued);
+    InjectedSize.fetch_add(1);
+    Pending.fetch_add(1);
+}
+
+void TWorkStealingExecuter::NotifyWorkers(size_t added) {
+    if (added == 0 || Sleeping.load() == 0) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> sleepLock(SleepMutex);
+    if (added == 1) {
+        WorkAvailable.notify_one();
+    } else {
+        WorkAvailable.notify_all();
+    }
+}
+
+size_t TWorkStealingExecuter::Size() {
+    return Pending.load();
+}
+
+size_t TWorkStealingExecuter::ThreadCount() const {
+    return Threads.size();
+}
+
+const TExecuterMetrics* TWorkStealingExecuter::Metrics() const {
+    return Metrics_.get();
+}
+
+void TWorkStealingExecuter::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(SleepMutex);
+        Stopping.store(true);
+        WorkAvailable.notify_all();
+    }
+
+    for (auto& thread : Threads) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+
+    if (Metrics_) {
+        Metrics_->OnStop();
+    }
+}
+
+TWorkStealingExecuter::~TWorkStealingExecuter() {
+    Stop();
+}
+
+void TWorkStealingExecuter::WorkerLoop(size_t workerIndex) {
+    std::minstd_rand random(workerIndex + 1);
+    const auto& cancellation = *CancellationToken();
+    auto idleBegin = Metrics_ ? TExecuterMetrics::Now() : TMetricsClock::time_point{};
+    while (true) {
+        TQueuedTask* task = nullptr;
+        for (size_t spin = 0; (task == nullptr) && (spin != SpinCount); ++spin) {
+            if (!TryTake(workerIndex, random, task)) {
+                std::this_thread::yield();
+            }
+        }
+
+        if (task == nullptr) {
+            if (Stopping.load() && !HasWork()) {
+                break;
+            }
+
+            WaitForWork();
+            continue;
+        }
+
+        OnTaken();
+
+        std::unique_ptr<TQueuedTask> holder(task);
+        if (Metrics_) {
+            Metrics_->OnIdle(workerIndex, idleBegin, TExecuterMetrics::Now());
+        }
+
+        RunQueuedTask(*holder, cancellation, Metrics_.get(), workerIndex, Exceptions);
+        if (Metrics_) {
+            idleBegin = TExecuterMetrics::Now();
+        }
+    }
+}
+
+bool TWorkStealingExecuter::TryTake(size_t workerIndex, std::minstd_rand& random, TQueuedTask*& task) {
+    if (Deques[workerIndex]->Pop(task)) {
+        return true;
+    }
+
+    if (TakeInjected(workerIndex, task)) {
+        return true;
+    }
+
+    size_t victim = random() % Deques.size();
+    for (size_t i = 0; i != Deques.size(); ++i) {
+        if (victim != workerIndex && Deques[victim]->Steal(task)) {
+            return true;
+        }
+
+        victim = (victim + 1) % Deques.size();
+    }
+
+    return false;
+}
+
+// takes the oldest injected task and moves a fair share of the next ones to the own deque
+bool TWorkStealingExecuter::TakeInjected(size_t workerIndex, TQueuedTask*& task) {
+    if (InjectedSize.load() == 0) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(InjectMutex);
+    if (Injected.empty()) {
+        return false;
+    }
+
+    task = Injected.front();
+    Injected.pop_front();
+    size_t batch = std::min(Injected.size() / Deques.size(), MaxInjectedBatch);
+    for (size_t i = 0; i != batch; ++i) {
+        Deques[workerIndex]->Push(Injected.front());
+        Injected.pop_front();
+    }
+
+    InjectedSize.fetch_sub(batch + 1);
+    return true;
+}
+
+bool TWorkStealingExecuter::HasWork() const {
+    return Pending.load() != 0;
+}
+
+void TWorkStealingExecuter::WaitForWork() {
+    std::unique_lock<std::mutex> lock(SleepMutex);
+    Sleeping.fetch_add(1);
+    WorkAvailable.wait(lock, [this]() {
+        return HasWork() || Stopping.load();
+    });
+    Sleeping.fetch_sub(1);
+}
+
+void TWorkStealingExecuter::WaitForSpace() {
+    if (Pending.load() < MaxSize) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(SleepMutex);
+    // tasks of the current batch are not announced yet
+    WorkAvailable.notify_all();
+    ProducerBlocked.store(true);
+    SpaceAvailable.wait(lock, [this]() {
+        return Pending.load() < MaxSize;
+    });
+    ProducerBlocked.store(false);
+}
+
+void TWorkStealingExecuter::OnTaken() {
+    Pending.fetch_sub(1);
+    if (ProducerBlocked.load()) {
+        std::lock_guard<std::mutex> lock(SleepMutex);
+        SpaceAvailable.notify_one();
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "cpu_topology.h"
+#include "executer.h"
+#include "executer_metrics.h"
+#include "work_stealing_deque.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+/*
+ * Executer with a Chase-Lev deque per worker.
+ * A worker pops the newest task of its own deque, tasks added by a worker go to its deque
+ * without any locking. Tasks of other threads go to a shared injection queue,
+ * a worker moves a small batch of them to its deque when its deque is empty.
+ * A worker without local or injected tasks steals the oldest ones of random victims,
+ * so workers do not contend on a single lock. Idle workers spin for a while
+ * and then park until new tasks arrive.
+ */
+class TWorkStealingExecuter : public IExecuter {
+public:
+    explicit TWorkStealingExecuter(size_t threadCount, size_t maxSize, TMultiThreadQueue<std::exception_ptr>* exceptions, std::vector<TCpu> layout = {}, std::unique_ptr<TExecuterMetrics> metrics = nullptr);
+
+    using IExecuter::Add;
+
+    void Add(TInlineTask&& task) override;
+
+    void AddBatch(std::vector<TInlineTask>&& tasks) override;
+
+    size_t Size() override;
+
+    size_t ThreadCount() const override;
+
+    const TExecuterMetrics* Metrics() const override;
+
+    void Stop() override;
+
+    ~TWorkStealingExecuter() override;
+
+private:
+    void WorkerLoop(size_t workerIndex);
+
+    bool TryTake(size_t workerIndex, std::minstd_rand& random, TQueuedTask*& task);
+
+    bool TakeInjected(size_t workerIndex, TQueuedTask*& task);
+
+    bool HasWork() const;
+
+    void WaitForWork();
+
+    void WaitForSpace();
+
+    void OnTaken();
+
+    void PushLocked(TInlineTask&& task, TMetricsClock::time_point enqueued);
+
+    void NotifyWorkers(size_t added);
+
+    std::vector<std::unique_ptr<TWorkStealingDeque<TQueuedTask*>>> Deques;
+    std::vector<std::thread> Threads;
+    TMultiThreadQueue<std::exception_ptr>* Exceptions;
+    size_t MaxSize;
+    const std::vector<TCpu> Layout;
+    std::unique_ptr<TExecuterMetrics> Metrics_;
+
+    // serializes producers which are not workers of this executer
+    std::mutex AddMutex;
+
+    // tasks of those producers, a producer waiting for space does not hold InjectMutex
+    std::mutex InjectMutex;
+    std::deque<TQueuedTask*> Injected;
+    std::atomic<size_t> InjectedSize;
+
+    std::atomic<size_t> Pending;
+    std::atomic<size_t> Sleeping;
+    std::atomic<bool> ProducerBlocked;
+    std::atomic<bool> Stopping;
+
+    std::mutex SleepMutex;
+    std::condition_variable WorkAvailable;
+    std::condition_variable SpaceAvailable;
+};
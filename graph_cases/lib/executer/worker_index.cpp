@@ -0,0 +1,15 @@
+#include "worker_index.h"
+
+namespace {
+    thread_local const IExecuter* WorkerExecuter = nullptr;
+    thread_local size_t WorkerIndex = NoWorkerIndex;
+}
+
+size_t CurrentWorkerIndex(const IExecuter* executer) {
+    return (executer != nullptr && executer == WorkerExecuter) ? WorkerIndex : NoWorkerIndex;
+}
+
+void SetCurrentWorker(const IExecuter* executer, size_t index) {
+    WorkerExecuter = executer;
+    WorkerIndex = index;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+
+class IExecuter;
+
+constexpr size_t NoWorkerIndex = std::numeric_limits<size_t>::max();
+
+/*
+ * Index of the worker of the given executer running on the current thread,
+ * NoWorkerIndex on threads that are not its workers (e.g. the producer,
+ * or a worker of another executer).
+ * Workers of one executer get indices 0 .. ThreadCount() - 1.
+ */
+size_t CurrentWorkerIndex(const IExecuter* executer);
+
+void SetCurrentWorker(const IExecuter* executer, size_t index);
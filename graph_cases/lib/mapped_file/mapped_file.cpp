@@ -0,0 +1,59 @@
+#include "mapped_file.h"
+
+#include <cerrno>
+#include <stdexcept>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+TMappedFile::TMappedFile(const std::string& path)
+    : Data_(nullptr)
+    , Size_(0)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "can not open " + path);
+    }
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        int error = errno;
+        ::close(fd);
+        throw std::system_error(error, std::generic_category(), "can not stat " + path);
+    }
+
+    if (!S_ISREG(info.st_mode)) {
+        ::close(fd);
+        throw std::invalid_argument("can not map " + path + ": not a regular file");
+    }
+
+    Size_ = static_cast<size_t>(info.st_size);
+    // an empty file can not be mapped
+    if (Size_ != 0) {
+        void* mapping = ::mmap(nullptr, Size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            int error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::generic_category(), "can not map " + path);
+        }
+
+        ::madvise(mapping, Size_, MADV_SEQUENTIAL);
+        Data_ = static_cast<const char*>(mapping);
+    }
+
+    ::close(fd);
+}
+
+bool TMappedFile::CanMap(const std::string& path) {
+    struct stat info;
+    return ::stat(path.c_str(), &info) == 0 && S_ISREG(info.st_mode);
+}
+
+TMappedFile::~TMappedFile() {
+    if (Data_ != nullptr) {
+        ::munmap(const_cast<char*>(Data_), Size_);
+    }
+}
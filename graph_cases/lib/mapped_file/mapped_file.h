@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+/*
+ * Read-only memory mapping of a whole file.
+ * The contents are read in place, without copying them into a buffer.
+ * Only regular files can be mapped, pipes and devices report no size.
+ */
+class TMappedFile {
+public:
+    explicit TMappedFile(const std::string& path);
+
+    // false for pipes, devices and missing files, they have to be read as streams
+    static bool CanMap(const std::string& path);
+
+    TMappedFile(const TMappedFile&) = delete;
+
+    TMappedFile& operator=(const TMappedFile&) = delete;
+
+    const char* Data() const {
+        return Data_;
+    }
+
+    size_t Size() const {
+        return Size_;
+    }
+
+    std::string_view View() const {
+        return {Data_, Size_};
+    }
+
+    ~TMappedFile();
+
+private:
+    const char* Data_;
+    size_t Size_;
+};
@@ -1 +1,57 @@
-#include "combinatorics.h"
\ No newline at end of file
+#include "combinatorics.h"
+
+#include "binomial_coefficients/binomial_coefficients.h"
+
+#include <stdexcept>
+
+namespace {
+    uint64_t Binomial(size_t n, size_t k) {
+        if (k > n) {
+            return 0;
+        }
+
+        return static_cast<uint64_t>(BinomialCoefficient(n, k));
+    }
+}
+
+uint64_t CombinationRank(size_t n, const std::vector<size_t>& combination) {
+    size_t k = combination.size();
+    uint64_t rank = 0;
+    size_t first = 0;
+    for (size_t i = 0; i != k; ++i) {
+        // combinations which have a smaller element at position i come first
+        for (size_t value = first; value < combination[i]; ++value) {
+            rank += Binomial(n - 1 - value, k - 1 - i);
+        }
+
+        first = combination[i] + 1;
+    }
+
+    return rank;
+}
+
+std::vector<size_t> CombinationUnrank(size_t n, size_t k, uint64_t rank) {
+    if (rank >= Binomial(n, k)) {
+        throw std::out_of_range("combination rank is out of range");
+    }
+
+    std::vector<size_t> combination;
+    combination.reserve(k);
+    size_t value = 0;
+    for (size_t i = 0; i != k; ++i) {
+        while (true) {
+            uint64_t count = Binomial(n - 1 - value, k - 1 - i);
+            if (rank < count) {
+                break;
+            }
+
+            rank -= count;
+            ++value;
+        }
+
+        combination.push_back(value);
+        ++value;
+    }
+
+    return combination;
+}
@@ -4,6 +4,7 @@
 #include "traits.h"
 
 #include <cstddef>
+#include <cstdint>
 #include <utility>
 #include <vector>
 #include <type_traits>
@@ -218,6 +219,14 @@ private:
     TIterator End;
 };
 
+/*
+ * Position of a k-combination of {0, ..., n - 1} in the order of TChoiceGenerator
+ * (lexicographic), and the combination at a given position.
+ */
+uint64_t CombinationRank(size_t n, const std::vector<size_t>& combination);
+
+std::vector<size_t> CombinationUnrank(size_t n, size_t k, uint64_t rank);
+
 namespace std {
     template<>
     struct iterator_traits<TChoiceGenerator> {
@@ -1,26 +1,45 @@
 #pragma once
 
-#include "sum.h"
 #include "traits.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <iterator>
+#include <vector>
 
+/*
+ * Computes elementary symmetric polynomials e_0, ..., e_r of the range
+ * in a single pass: e_i is updated as e_i + x * e_{i - 1} for every element x,
+ * so the cost is O(size * r) instead of C(size, r) products.
+ * Polynomials of degree greater than the size of the range are zero.
+ */
 template<typename TIterator>
-typename TIteratorDereferencer<TIterator>::TRawType Sigma(size_t n, TIterator begin, TIterator end) {
-    if (n == 1) {
-        return SumRange(begin, end);
-    }
+std::vector<typename TIteratorDereferencer<TIterator>::TRawType> ElementarySymmetricPolynomials(size_t r, TIterator begin, TIterator end) {
+    using TValue = typename TIteratorDereferencer<TIterator>::TRawType;
+
+    std::vector<TValue> result(r + 1, TValue{});
+    result[0] = TValue{1};
 
-    size_t startDistance = std::distance(begin, end);
-    typename TIteratorDereferencer<TIterator>::TRawType ans{};
-    for (size_t i = 0; i + n - 1 != startDistance; ++i) {
-        auto value = *begin;
-        ++begin;
-        ans += value * Sigma(n - 1, begin, end);
+    size_t processed = 0;
+    for (; begin != end; ++begin) {
+        ++processed;
+        const TValue value = *begin;
+        for (size_t i = std::min(r, processed); i > 0; --i) {
+            result[i] += value * result[i - 1];
+        }
     }
 
-    return ans;
+    return result;
+}
+
+template<typename TContainer>
+std::vector<typename TContainer::value_type> ElementarySymmetricPolynomials(size_t r, const TContainer& container) {
+    return ElementarySymmetricPolynomials(r, std::begin(container), std::end(container));
+}
+
+template<typename TIterator>
+typename TIteratorDereferencer<TIterator>::TRawType Sigma(size_t n, TIterator begin, TIterator end) {
+    return ElementarySymmetricPolynomials(n, begin, end)[n];
 }
 
 template<typename TContainer>
@@ -0,0 +1,240 @@
+#include "acyclic_count_table.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+namespace NMultipartiteGraphs {
+    struct TAcyclicCountTable::THeader {
+        char Magic[4];
+        uint32_t Version;
+        uint64_t Capacity;
+        uint64_t Count;
+        uint64_t Reserved;
+    };
+
+    struct TAcyclicCountTable::TSlot {
+        int64_t Value;
+        // zero for an empty slot
+        uint16_t Length;
+        uint16_t Components[MaxComponents];
+        uint16_t Reserved;
+    };
+
+    namespace {
+        constexpr char Magic[4] = {'C', 'H', 'A', 'C'};
+        constexpr uint32_t Version = 1;
+        constexpr uint64_t MinCapacity = 64;
+
+        bool Storable(const std::vector<INT>& components) {
+            return !components.empty() && components.size() <= TAcyclicCountTable::MaxComponents
+                && std::all_of(components.begin(), components.end(), [](INT x) { return x <= UINT16_MAX; });
+        }
+
+        uint64_t Hash(const std::vector<INT>& components) {
+            uint64_t result = 14695981039346656037ull;
+            for (auto component : components) {
+                result = (result ^ component) * 1099511628211ull;
+            }
+
+            return result;
+        }
+
+        template<typename TSlot>
+        bool SameKey(const TSlot& slot, const std::vector<INT>& components) {
+            if (slot.Length != components.size()) {
+                return false;
+            }
+
+            for (size_t i = 0; i != components.size(); ++i) {
+                if (slot.Components[i] != components[i]) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        [[noreturn]] void ThrowErrno(const std::string& what) {
+            throw std::system_error(errno, std::generic_category(), what);
+        }
+
+        class TFileLock {
+        public:
+            explicit TFileLock(const std::string& path)
+                : Fd(::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644))
+            {
+                if (Fd < 0) {
+                    ThrowErrno("can not open " + path);
+                }
+
+                if (::flock(Fd, LOCK_EX) != 0) {
+                    ::close(Fd);
+                    ThrowErrno("can not lock " + path);
+                }
+            }
+
+            ~TFileLock() {
+                ::flock(Fd, LOCK_UN);
+                ::close(Fd);
+            }
+
+        private:
+            int Fd;
+        };
+    }
+
+    TAcyclicCountTable::TAcyclicCountTable(const std::string& path) {
+        static_assert(sizeof(TSlot) == 40, "slots are a part of the file format");
+
+        if (::access(path.c_str(), F_OK) != 0) {
+            return;
+        }
+
+        File = std::make_unique<TMappedFile>(path);
+        if (File->Size() < sizeof(THeader)) {
+            throw std::runtime_error("acyclic count table is truncated: " + path);
+        }
+
+        const auto* header = Header();
+        if (std::memcmp(header->Magic, Magic, sizeof(Magic)) != 0 || header->Version != Version) {
+            throw std::runtime_error("not an acyclic count table: " + path);
+        }
+
+        uint64_t capacity = header->Capacity;
+        // a full table has no empty slot to end a probe
+        if (capacity == 0 || (capacity & (capacity - 1)) != 0 || header->Count >= capacity || File->Size() != sizeof(THeader) + capacity * sizeof(TSlot)) {
+            throw std::runtime_error("acyclic count table is malformed: " + path);
+        }
+    }
+
+    const TAcyclicCountTable::THeader* TAcyclicCountTable::Header() const {
+        return reinterpret_cast<const THeader*>(File->Data());
+    }
+
+    const TAcyclicCountTable::TSlot* TAcyclicCountTable::Slots() const {
+        return reinterpret_cast<const TSlot*>(File->Data() + sizeof(THeader));
+    }
+
+    std::optional<long long> TAcyclicCountTable::Find(const std::vector<INT>& components) const {
+        if (!File || !Storable(components)) {
+            return std::nullopt;
+        }
+
+        // the probe is bounded, a header with a wrong count must not hang it
+        uint64_t capacity = Header()->Capacity;
+        uint64_t mask = capacity - 1;
+        const auto* slots = Slots();
+        uint64_t index = Hash(components) & mask;
+        for (uint64_t probe = 0; probe != capacity; ++probe, index = (index + 1) & mask) {
+            const auto& slot = slots[index];
+            if (slot.Length == 0) {
+                return std::nullopt;
+            }
+
+            if (SameKey(slot, components)) {
+                return slot.Value;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    size_t TAcyclicCountTable::Size() const {
+        return File ? static_cast<size_t>(Header()->Count) : 0;
+    }
+
+    TAcyclicCountTable::TEntries TAcyclicCountTable::Entries() const {
+        TEntries result;
+        if (!File) {
+            return result;
+        }
+
+        const auto* slots = Slots();
+        for (uint64_t index = 0; index != Header()->Capacity; ++index) {
+            const auto& slot = slots[index];
+            if (slot.Length != 0) {
+                result.emplace_back(std::vector<INT>(slot.Components, slot.Components + slot.Length), slot.Value);
+            }
+        }
+
+        return result;
+    }
+
+    void TAcyclicCountTable::Merge(const std::string& path, const TEntries& entries) {
+        TFileLock lock(path + ".lock");
+
+        std::map<std::vector<INT>, long long> merged;
+        for (auto& [components, value] : TAcyclicCountTable(path).Entries()) {
+            merged.emplace(std::move(components), value);
+        }
+
+        for (const auto& [components, value] : entries) {
+            if (Storable(components)) {
+                merged.emplace(components, value);
+            }
+        }
+
+        // the load factor is at most one half
+        uint64_t capacity = MinCapacity;
+        while (capacity < 2 * merged.size()) {
+            capacity <<= 1;
+        }
+
+        std::vector<char> content(sizeof(THeader) + capacity * sizeof(TSlot), 0);
+        auto* header = reinterpret_cast<THeader*>(content.data());
+        std::memcpy(header->Magic, Magic, sizeof(Magic));
+        header->Version = Version;
+        header->Capacity = capacity;
+        header->Count = merged.size();
+
+        auto* slots = reinterpret_cast<TSlot*>(content.data() + sizeof(THeader));
+        for (const auto& [components, value] : merged) {
+            uint64_t index = Hash(components) & (capacity - 1);
+            while (slots[index].Length != 0) {
+                index = (index + 1) & (capacity - 1);
+            }
+
+            auto& slot = slots[index];
+            slot.Value = value;
+            slot.Length = static_cast<uint16_t>(components.size());
+            std::copy(components.begin(), components.end(), slot.Components);
+        }
+
+        std::string temporary = path + ".tmp." + std::to_string(::getpid());
+        int fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            ThrowErrno("can not create " + temporary);
+        }
+
+        size_t written = 0;
+        while (written < content.size()) {
+            auto result = ::write(fd, content.data() + written, content.size() - written);
+            if (result < 0) {
+                ::close(fd);
+                ::unlink(temporary.c_str());
+                ThrowErrno("can not write " + temporary);
+            }
+
+            written += static_cast<size_t>(result);
+        }
+
+        bool synced = ::fsync(fd) == 0;
+        if (::close(fd) != 0 || !synced) {
+            ::unlink(temporary.c_str());
+            ThrowErrno("can not write " + temporary);
+        }
+
+        if (::rename(temporary.c_str(), path.c_str()) != 0) {
+            ::unlink(temporary.c_str());
+            ThrowErrno("can not replace " + path);
+        }
+    }
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "local_types.h"
+#include "mapped_file/mapped_file.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace NMultipartiteGraphs {
+    /*
+     * On-disk table of acyclic orientation counts of complete multipartite graphs,
+     * keyed by the sorted partition. The file is an open-addressing hash table
+     * with linear probing which is mapped read-only and used in place.
+     * Partitions with more than MaxComponents components or components
+     * larger than 65535 are not stored. The layout is native, the file is meant
+     * to be shared by processes on one host.
+     */
+    class TAcyclicCountTable {
+    public:
+        static constexpr size_t MaxComponents = 14;
+
+        using TEntries = std::vector<std::pair<std::vector<INT>, long long>>;
+
+        // a missing file is an empty table, a malformed one throws std::runtime_error
+        explicit TAcyclicCountTable(const std::string& path);
+
+        // components should be sorted
+        std::optional<long long> Find(const std::vector<INT>& components) const;
+
+        size_t Size() const;
+
+        TEntries Entries() const;
+
+        /*
+         * Adds entries to the table in the file. Writers are serialized by flock
+         * on path + ".lock", the new table is written to a temporary file
+         * and renamed over the old one, so readers keep their mapping intact.
+         */
+        static void Merge(const std::string& path, const TEntries& entries);
+
+    private:
+        struct THeader;
+        struct TSlot;
+
+        const THeader* Header() const;
+
+        const TSlot* Slots() const;
+
+        std::unique_ptr<TMappedFile> File;
+    };
+}
@@ -9,16 +9,74 @@ namespace NMultipartiteGraphs {
     long long TCompleteGraphAcyclicOrientationsCounter::operator()(std::vector<INT> components) {
         std::sort(components.begin(), components.end());
 
-        if (auto iter = Cache.find(components); iter != Cache.end()) {
-            return iter->second;
+        TKey key;
+        if (MakeKey(components, key)) {
+            std::shared_lock<std::shared_mutex> lock(M);
+            if (auto value = Cache.Find(key)) {
+                return *value;
+            }
+        }
+
+        if (auto value = FindInTable(components)) {
+            return *value;
         }
 
         return Compute(components);
     }
 
+    void TCompleteGraphAcyclicOrientationsCounter::AttachTable(const std::string& path) {
+        std::unique_lock<std::shared_mutex> lock(M);
+        Table = std::make_unique<TAcyclicCountTable>(path);
+        TablePath = path;
+    }
+
+    void TCompleteGraphAcyclicOrientationsCounter::SaveTable() {
+        TAcyclicCountTable::TEntries entries;
+        std::string path;
+        {
+            std::shared_lock<std::shared_mutex> lock(M);
+            if (!Table) {
+                return;
+            }
+
+            path = TablePath;
+            Cache.ForEach([&entries](const TKey& key, long long value) {
+                // the count does not depend on the order of components
+                std::vector<INT> components(key.begin(), key.end());
+                std::sort(components.begin(), components.end());
+                entries.emplace_back(std::move(components), value);
+            });
+        }
+
+        TAcyclicCountTable::Merge(path, entries);
+    }
+
+    void TCompleteGraphAcyclicOrientationsCounter::SetMemoBudget(size_t bytes) {
+        std::unique_lock<std::shared_mutex> lock(M);
+        Cache.Reset(decltype(Cache)::CapacityForBudget(bytes));
+    }
+
+    TCacheStats TCompleteGraphAcyclicOrientationsCounter::MemoStats() {
+        std::shared_lock<std::shared_mutex> lock(M);
+        return Cache.Stats();
+    }
+
+    std::optional<long long> TCompleteGraphAcyclicOrientationsCounter::FindInTable(std::vector<INT> components) const {
+        if (!Table || Table->Size() == 0) {
+            return std::nullopt;
+        }
+
+        std::sort(components.begin(), components.end());
+        return Table->Find(components);
+    }
+
     long long TCompleteGraphAcyclicOrientationsCounter::ComputeUnsafe(const std::vector<INT>& components) {
-        if (auto iter = Cache.find(components); iter != Cache.end()) {
-            return iter->second;
+        TKey key;
+        bool cacheable = MakeKey(components, key);
+        if (cacheable) {
+            if (auto value = Cache.Find(key)) {
+                return *value;
+            }
         }
 
         if (components.size() == 0) {
@@ -29,17 +87,26 @@ namespace NMultipartiteGraphs {
             return 1;
         }
 
+        if (auto value = FindInTable(components)) {
+            if (cacheable) {
+                Cache.Insert(key, *value);
+            }
+            return *value;
+        }
+
         long long result = 0;
         for (size_t i = 0; i != components.size(); ++i) {
             result += ComputeUnsafeForComponent(components, i);
         }
 
-        Cache[components] = result;
+        if (cacheable) {
+            Cache.Insert(key, result);
+        }
         return result;
     }
 
     long long TCompleteGraphAcyclicOrientationsCounter::Compute(const std::vector<INT>& components) {
-        std::lock_guard<std::mutex> lock(M);
+        std::unique_lock<std::shared_mutex> lock(M);
         return ComputeUnsafe(components);
     }
 
@@ -1,10 +1,17 @@
 #pragma once
 
+#include "acyclic_count_table.h"
 #include "local_types.h"
+#include "clock_cache/clock_cache.h"
+#include "clock_cache/inline_key.h"
 
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
 #include <vector>
-#include <unordered_map>
 #include <mutex>
+#include <shared_mutex>
 
 
 namespace NMultipartiteGraphs {
@@ -12,19 +19,30 @@ namespace NMultipartiteGraphs {
     public:
         long long operator()(std::vector<INT> components);
 
+        /*
+         * Looks counts up in the persistent table of the file too.
+         * Should be called before the counter is used.
+         */
+        void AttachTable(const std::string& path);
+
+        // merges every count in the memo into the attached file
+        void SaveTable();
+
+        /*
+         * Bounds the memory of the memo, evicted counts are recomputed on demand.
+         * Zero is unbounded. Drops the memo, should be called before the counter is used.
+         */
+        void SetMemoBudget(size_t bytes);
+
+        TCacheStats MemoStats();
+
     private:
-        class TVectorHasher {
-        public:
-           size_t operator()(const std::vector<INT>& v) const {
-               size_t result = 0;
-               std::hash<INT> elementHasher{};
-               for (const auto x : v) {
-                   result ^= elementHasher(x);
-               }
-
-               return result;
-           }
-        };
+        // partitions with more parts or larger parts are computed without the memo
+        using TKey = TInlineKey<uint16_t, 23>;
+
+        static bool MakeKey(const std::vector<INT>& components, TKey& key) {
+            return key.Assign(components.begin(), components.end());
+        }
 
         long long Compute(const std::vector<INT>& components);
 
@@ -32,7 +50,11 @@ namespace NMultipartiteGraphs {
 
         long long ComputeUnsafeForComponent(const std::vector<INT>& components, size_t component);
 
-        std::unordered_map<std::vector<INT>, long long, TVectorHasher> Cache;
-        std::mutex M;
+        std::optional<long long> FindInTable(std::vector<INT> components) const;
+
+        TClockCache<TKey, long long, TKey::THasher> Cache;
+        std::shared_mutex M;
+        std::string TablePath;
+        std::unique_ptr<TAcyclicCountTable> Table;
     };
 }
\ No newline at end of file
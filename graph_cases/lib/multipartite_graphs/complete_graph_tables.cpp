@@ -0,0 +1,55 @@
+#include "complete_graph_tables.h"
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+
+#ifndef MULTIPARTITE_GRAPHS_NO_TABLES
+#include "complete_graph_tables.inc"
+#endif
+
+namespace NMultipartiteGraphs {
+    size_t PartitionIndex(const std::vector<INT>& components) {
+        size_t vertices = std::accumulate(components.begin(), components.end(), size_t{0});
+        size_t index = 0;
+        for (size_t n = 0; n != vertices; ++n) {
+            index += PartitionCounts[n][n];
+        }
+
+        size_t remaining = vertices;
+        for (auto part : components) {
+            // partitions of the rest with a smaller largest part come first
+            for (size_t first = 1; first < part; ++first) {
+                index += PartitionCounts[remaining - first][first];
+            }
+
+            remaining -= part;
+        }
+
+        return index;
+    }
+
+    const TCompleteGraphTableEntry* FindCompleteGraphTableEntry(const std::vector<INT>& components) {
+#ifdef MULTIPARTITE_GRAPHS_NO_TABLES
+        (void)components;
+        return nullptr;
+#else
+        size_t vertices = 0;
+        for (auto component : components) {
+            if (component == 0) {
+                return nullptr;
+            }
+
+            vertices += component;
+        }
+
+        if (vertices > CompleteGraphTableMaxVertices) {
+            return nullptr;
+        }
+
+        std::vector<INT> sorted = components;
+        std::sort(sorted.begin(), sorted.end(), std::greater<INT>());
+        return &CompleteGraphTable[PartitionIndex(sorted)];
+#endif
+    }
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "local_types.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace NMultipartiteGraphs {
+    /*
+     * Invariants of a complete multipartite graph with at most
+     * CompleteGraphTableMaxVertices vertices. The tables are generated
+     * at build time by complete_graph_tables_generator and indexed by PartitionIndex.
+     */
+    struct TCompleteGraphTableEntry {
+        // elementary symmetric polynomials e_0, ..., e_3 of the components
+        std::array<INT, 4> Sigmas;
+        INT I4;
+        INT Pt;
+        long long AcyclicOrientations;
+    };
+
+    constexpr size_t CompleteGraphTableMaxVertices = 20;
+
+    using TPartitionCounts = std::array<std::array<uint64_t, CompleteGraphTableMaxVertices + 1>, CompleteGraphTableMaxVertices + 1>;
+
+    // [n][m] is the number of partitions of n into parts which are at most m
+    constexpr TPartitionCounts CountPartitions() {
+        TPartitionCounts counts{};
+        for (size_t m = 0; m <= CompleteGraphTableMaxVertices; ++m) {
+            counts[0][m] = 1;
+        }
+
+        for (size_t n = 1; n <= CompleteGraphTableMaxVertices; ++n) {
+            for (size_t m = 1; m <= CompleteGraphTableMaxVertices; ++m) {
+                counts[n][m] = counts[n][m - 1] + (m <= n ? counts[n - m][m] : 0);
+            }
+        }
+
+        return counts;
+    }
+
+    constexpr TPartitionCounts PartitionCounts = CountPartitions();
+
+    // number of partitions of every n up to CompleteGraphTableMaxVertices
+    constexpr size_t CountAllPartitions() {
+        size_t result = 0;
+        for (size_t n = 0; n <= CompleteGraphTableMaxVertices; ++n) {
+            result += PartitionCounts[n][n];
+        }
+
+        return result;
+    }
+
+    constexpr size_t CompleteGraphTableSize = CountAllPartitions();
+
+    /*
+     * Minimal perfect index of a partition in [0, CompleteGraphTableSize):
+     * partitions are grouped by the number of vertices and ranked
+     * by the largest part, then by the rest recursively.
+     * Components should be positive and sorted in the descending order
+     * with at most CompleteGraphTableMaxVertices vertices.
+     */
+    size_t PartitionIndex(const std::vector<INT>& components);
+
+    // null for graphs out of the table or when the library is built without tables
+    const TCompleteGraphTableEntry* FindCompleteGraphTableEntry(const std::vector<INT>& components);
+}
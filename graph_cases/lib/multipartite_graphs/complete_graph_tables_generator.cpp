@@ -0,0 +1,122 @@
+#include "acyclic_orintations.h"
+#include "complete_graph_tables.h"
+#include "multipartite_graphs.h"
+
+#include "math_utils/sigma.h"
+#include "singleton/singleton.h"
+
+#include "binomial_coefficients/binomial_coefficients.h"
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+/*
+ * Writes complete_graph_tables.inc: invariants of every complete multipartite
+ * graph with at most CompleteGraphTableMaxVertices vertices, in the order of PartitionIndex.
+ * It is linked with the library built without tables.
+ */
+namespace {
+    using NMultipartiteGraphs::TCompleteGraphTableEntry;
+
+    // the recursion of TCompleteGraphAcyclicOrientationsCounter is too slow for the whole table,
+    // it is checked against TSourceCounter up to this number of vertices
+    constexpr INT CheckedVertices = 10;
+
+    /*
+     * Counts acyclic orientations by the nonempty sets of sources: they are independent,
+     * so they lie in one part, and by inclusion-exclusion
+     * a(G) = sum over parts i and 1 <= j <= n_i of (-1)^(j + 1) C(n_i, j) a(G with n_i - j).
+     * The sum of absolute values of the terms is at most e * n!, so it fits for 20 vertices.
+     */
+    class TSourceCounter {
+    public:
+        long long operator()(std::vector<INT> components) {
+            components.erase(std::remove(components.begin(), components.end(), 0), components.end());
+            std::sort(components.begin(), components.end());
+            if (components.size() <= 1) {
+                return 1;
+            }
+
+            if (auto iter = Cache.find(components); iter != Cache.end()) {
+                return iter->second;
+            }
+
+            long long result = 0;
+            for (size_t i = 0; i != components.size(); ++i) {
+                for (INT j = 1; j <= components[i]; ++j) {
+                    auto rest = components;
+                    rest[i] -= j;
+                    long long term = BinomialCoefficient(components[i], j) * (*this)(rest);
+                    result += (j % 2 == 1) ? term : -term;
+                }
+            }
+
+            Cache.emplace(components, result);
+            return result;
+        }
+
+    private:
+        std::map<std::vector<INT>, long long> Cache;
+    };
+
+    void GeneratePartitions(std::vector<INT>& current, INT remaining, INT bound, std::vector<std::optional<TCompleteGraphTableEntry>>& table) {
+        if (remaining == 0) {
+            NMultipartiteGraphs::TCompleteGraph graph(current);
+            auto sigmas = ElementarySymmetricPolynomials(3, current);
+            TCompleteGraphTableEntry entry{{sigmas[0], sigmas[1], sigmas[2], sigmas[3]}, graph.I4Invariant(), graph.PtInvariant(), 0};
+            static TSourceCounter counter;
+            entry.AcyclicOrientations = counter(current);
+            if (entry.Sigmas[1] <= CheckedVertices && entry.AcyclicOrientations != TSingleton<NMultipartiteGraphs::TCompleteGraphAcyclicOrientationsCounter>::Instance()(current)) {
+                throw std::logic_error("acyclic orientation counters disagree");
+            }
+
+            auto& slot = table.at(NMultipartiteGraphs::PartitionIndex(current));
+            if (slot) {
+                throw std::logic_error("partition index is not injective");
+            }
+            slot = entry;
+            return;
+        }
+
+        for (INT part = std::min(remaining, bound); part > 0; --part) {
+            current.push_back(part);
+            GeneratePartitions(current, remaining - part, part, table);
+            current.pop_back();
+        }
+    }
+}
+
+int main(int argc, const char ** argv) {
+    if (argc != 2) {
+        std::cerr << "usage: " << argv[0] << " OUTPUT" << std::endl;
+        return 1;
+    }
+
+    std::vector<std::optional<TCompleteGraphTableEntry>> table(NMultipartiteGraphs::CompleteGraphTableSize);
+    for (INT vertices = 0; vertices <= NMultipartiteGraphs::CompleteGraphTableMaxVertices; ++vertices) {
+        std::vector<INT> current;
+        GeneratePartitions(current, vertices, vertices, table);
+    }
+
+    std::ofstream out(argv[1]);
+    out << "// generated by complete_graph_tables_generator, do not edit\n";
+    out << "namespace NMultipartiteGraphs {\n";
+    out << "    constexpr TCompleteGraphTableEntry CompleteGraphTable[CompleteGraphTableSize] = {\n";
+    for (const auto& entry : table) {
+        if (!entry) {
+            throw std::logic_error("partition index is not surjective");
+        }
+
+        out << "        {{" << entry->Sigmas[0] << "u, " << entry->Sigmas[1] << "u, " << entry->Sigmas[2] << "u, " << entry->Sigmas[3] << "u}, "
+            << entry->I4 << "u, " << entry->Pt << "u, " << entry->AcyclicOrientations << "ll},\n";
+    }
+    out << "    };\n";
+    out << "}\n";
+
+    return out ? 0 : 1;
+}
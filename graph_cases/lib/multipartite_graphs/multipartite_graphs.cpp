@@ -10,7 +10,9 @@
 #include "math_utils/sigma.h"
 #include "math_utils/sum.h"
 
+#include <limits>
 #include <ostream>
+#include <stdexcept>
 #include <unordered_map>
 #include <queue>
 
@@ -75,102 +77,121 @@ bool IsXi2Subgraph(const NMultipartiteGraphs::TEdge& first, const NMultipartiteG
 
 
 namespace NMultipartiteGraphs {
-INT TCompleteGraph::VerticesCount() const {
-    return SumRange(begin(), end());
+TCompleteGraphSignature::TCompleteGraphSignature(std::vector<INT> components)
+    : TCompleteGraphSignature(std::move(components), FindCompleteGraphTableEntry(components))
+{
 }
 
+// I2 and I3 are e_2 and e_3 of the part sizes, both come from one pass
+TCompleteGraphSignature::TCompleteGraphSignature(std::vector<INT>&& components, const TCompleteGraphTableEntry* tableEntry)
+    : TCompleteGraphSignature(std::move(components), tableEntry,
+        tableEntry ? std::vector<INT>(tableEntry->Sigmas.begin(), tableEntry->Sigmas.end()) : ElementarySymmetricPolynomials(3, components))
+{
+}
+
+TCompleteGraphSignature::TCompleteGraphSignature(std::vector<INT>&& components, const TCompleteGraphTableEntry* tableEntry, const std::vector<INT>& sigmas)
+    : Components_(std::move(components))
+    , TableEntry_(tableEntry)
+    , VerticesCount_(sigmas[1])
+    , I2Invariant_(sigmas[2])
+    , I3Invariant_(sigmas[3])
+    , I4Invariant_(tableEntry ? tableEntry->I4 : ComputeI4())
+    , PtInvariant_(tableEntry ? tableEntry->Pt : ComputePtInvariant())
+{
+}
 
-INT TCompleteGraph::ComputeI4() const {
+INT TCompleteGraphSignature::ComputeI4() const {
     INT ans = 0;
-    for (size_t i = 0; i != Components.size() - 1; ++i) {
-        for (size_t j = i + 1; j != Components.size(); ++j) {
-            ans += BinomialCoefficient(Components[i], 2) * BinomialCoefficient(Components[j], 2);
-        }
+    if (Components_.size() < 2) {
+        return ans;
+    }
+
+    for (const auto [i, j] : TPairGenerator(Components_.size())) {
+        ans += BinomialCoefficient(Components_[i], 2) * BinomialCoefficient(Components_[j], 2);
     }
     return ans;
 }
 
-TCompleteGraph::TCompleteGraph(const std::initializer_list<INT>& components)
-    : Components{components}
-    , I3Invariant_(0)
-    , I4Invariant_(0)
-    , PtInvariant_(0)
-    , Edges_(Sigma(2, Components))
-    {
+// every part adds 2^(size - 1) - 1 modulo the width of INT, an empty part adds nothing
+INT TCompleteGraphSignature::ComputePtInvariant() const {
+    INT result = 0;
+    for (auto component : Components_) {
+        if (component == 0) {
+            continue;
+        }
+
+        if (component - 1 < static_cast<INT>(std::numeric_limits<INT>::digits)) {
+            result += INT(1) << (component - 1);
+        }
+        result -= 1;
     }
 
-INT TCompleteGraph::I2Invariant() const {
-    return Edges_;
+    return result;
 }
 
-INT TCompleteGraph::I3Invariant() const {
-    if (Components.size() < 3) {
-        return 0;
+INT TCompleteGraphSignature::CountAcyclicOrientations() const {
+    if (TableEntry_) {
+        return static_cast<INT>(TableEntry_->AcyclicOrientations);
     }
 
-    if (I3Invariant_ == 0) {
-        I3Invariant_ = Sigma(3, Components);
-    }
+    std::call_once(AcyclicOrientationsFlag, [this]() {
+        AcyclicOrientations_ = TSingleton<TCompleteGraphAcyclicOrientationsCounter>::Instance()(Components_);
+    });
 
-    return I3Invariant_;
+    return AcyclicOrientations_;
 }
 
-INT TCompleteGraph::I4Invariant() const {
-    if (Components.size() < 2) {
-        return 0;
-    }
+TCompleteGraph::TCompleteGraph()
+    : TCompleteGraph(std::vector<INT>{})
+{
+}
 
-    if (I4Invariant_ == 0) {
-        I4Invariant_ = ComputeI4();
-    }
+TCompleteGraph::TCompleteGraph(std::vector<INT> components)
+    : Signature_(std::make_shared<const TCompleteGraphSignature>(std::move(components)))
+{
+}
 
-    return I4Invariant_;
+TCompleteGraph::TCompleteGraph(const std::initializer_list<INT>& components)
+    : TCompleteGraph(std::vector<INT>(components))
+{
 }
 
+INT TCompleteGraph::VerticesCount() const {
+    return Signature_->VerticesCount();
+}
 
-INT TCompleteGraph::PtInvariant() const {
-    if (PtInvariant_ == 0) {
-        PtInvariant_ = CalculatePtInvariant();
-    }
+INT TCompleteGraph::I2Invariant() const {
+    return Signature_->I2Invariant();
+}
 
-    return PtInvariant_;
+INT TCompleteGraph::I3Invariant() const {
+    return Signature_->I3Invariant();
 }
 
-INT TCompleteGraph::CalculatePtInvariant() const {
-    INT result = 0;
-    for (auto component : Components) {
-        result += 1ull << (component - 1);
-    }
+INT TCompleteGraph::I4Invariant() const {
+    return Signature_->I4Invariant();
+}
 
-    return result - ComponentsNumber();
+INT TCompleteGraph::PtInvariant() const {
+    return Signature_->PtInvariant();
 }
 
 bool TCompleteGraph::operator==(const TCompleteGraph& other) const {
-    if (Components.size() != other.Components.size()) {
-        return false;
-    }
-
-    for (size_t i = 0; i < Components.size(); ++i) {
-        if (Components[i] != other.Components[i]) {
-            return false;
-        }
-    }
-
-    return true;
+    return Signature_->Components() == other.Signature_->Components();
 }
 
 INT TCompleteGraph::ComponentSize(size_t component) const {
-    return Components[component];
+    return Signature_->Components()[component];
 }
 
 
 size_t TCompleteGraph::ComponentsNumber() const {
-    return Components.size();
+    return Signature_->Components().size();
 }
 
 std::vector<TEdge> TCompleteGraph::GenerateEdgesBetweenComponents(size_t first, size_t second) const {
-    auto firstSize = Components[first];
-    auto secondSize = Components[second];
+    auto firstSize = ComponentSize(first);
+    auto secondSize = ComponentSize(second);
     std::vector<TEdge> edges;
     edges.reserve(firstSize * secondSize);
     for (INT i = 0; i < firstSize; ++i) {
@@ -185,11 +206,11 @@ std::vector<TEdge> TCompleteGraph::GenerateEdgesBetweenComponents(size_t first,
 }
 
 std::vector<INT>::const_iterator TCompleteGraph::begin() const {
-    return Components.begin();
+    return Signature_->Components().begin();
 }
 
 std::vector<INT>::const_iterator TCompleteGraph::end() const {
-    return Components.end();
+    return Signature_->Components().end();
 }
 
 std::vector<TEdge> TCompleteGraph::GenerateAllEdges() const {
@@ -205,11 +226,7 @@ std::vector<TEdge> TCompleteGraph::GenerateAllEdges() const {
 }
 
 INT TCompleteGraph::CountAcyclicOrientations() const {
-    if (AcyclicOrientations_ == 0) {
-       AcyclicOrientations_ = TSingleton<TCompleteGraphAcyclicOrientationsCounter>::Instance()(Components);
-    }
-
-    return AcyclicOrientations_;
+    return Signature_->CountAcyclicOrientations();
 }
 
 
@@ -232,11 +249,11 @@ INT TDenseGraph::I3Invariant() const {
         return 0;
     }
 
-    if (I3Invariant_ == 0) {
+    if (!I3Invariant_) {
         I3Invariant_ = Graph->I3Invariant() - ComputeXi1() + ComputeXi2AndXi3();
     }
 
-    return I3Invariant_;
+    return *I3Invariant_;
 
 }
 
@@ -283,10 +300,10 @@ INT TDenseGraph::ComputeXi2AndXi3() const {
 }
 
 INT TDenseGraph::I4Invariant() const {
-    if (I4Invariant_ == 0) {
+    if (!I4Invariant_) {
         I4Invariant_ = ComputeI4TwoParts() + ComputeI4ThreeParts();
     }
-    return I4Invariant_;
+    return *I4Invariant_;
 }
 
 INT TDenseGraph::ComputeI4TwoParts() const {
@@ -353,11 +370,11 @@ INT TDenseGraph::ComputeI4ThreeParts() const {
 }
 
 INT TDenseGraph::PtInvariant() const {
-    if (PtInvariant_ == 0) {
+    if (!PtInvariant_) {
         PtInvariant_ = ComputePtInvariant();
     }
 
-    return PtInvariant_;
+    return *PtInvariant_;
 }
 
 INT TDenseGraph::ComputePtInvariant() const {
@@ -466,6 +483,113 @@ TDenseGraph::TDenseGraph(const TDenseGraph& other)
 {
 }
 
+void TDenseGraph::DeleteEdgeInplace(const TEdge& edge) {
+    if (IsEdgeDeleted(edge)) {
+        throw std::logic_error("edge is already deleted");
+    }
+
+    if (I4Invariant_) {
+        I4Invariant_ = *I4Invariant_ - CountLostI4(edge) + CountGainedI4(edge);
+    }
+
+    if (PtInvariant_) {
+        PtInvariant_ = *PtInvariant_ + CountGarlandsWith(edge);
+    }
+
+    I3Invariant_.reset();
+    EdgeSet.insert(edge);
+}
+
+TDenseGraph TDenseGraph::DeleteEdge(const TEdge& edge) const {
+    TDenseGraph other(*this);
+    other.I4Invariant_ = I4Invariant_;
+    other.PtInvariant_ = PtInvariant_;
+    other.DeleteEdgeInplace(edge);
+    return other;
+}
+
+/*
+ * Quadrangles counted by I4 which contain the edge: the ones inside the two parts of the edge
+ * and the ones around an already deleted edge with the edge as a side.
+ */
+INT TDenseGraph::CountLostI4(const TEdge& edge) const {
+    INT answer = 0;
+    const auto& x = edge.First;
+    const auto& y = edge.Second;
+
+    for (size_t xIndex = 0; xIndex != Graph->ComponentSize(x.ComponentId); ++xIndex) {
+        auto otherX = TVertex(x.ComponentId, xIndex);
+        if (otherX == x || IsEdgeDeleted({otherX, y})) {
+            continue;
+        }
+
+        for (size_t yIndex = 0; yIndex != Graph->ComponentSize(y.ComponentId); ++yIndex) {
+            auto otherY = TVertex(y.ComponentId, yIndex);
+            if (otherY != y && !IsEdgeDeleted({x, otherY}) && !IsEdgeDeleted({otherX, otherY})) {
+                ++answer;
+            }
+        }
+    }
+
+    for (const auto& deleted : EdgeSet) {
+        for (const auto& [shared, middle] : {std::make_pair(x, y), std::make_pair(y, x)}) {
+            const TVertex* opposite = nullptr;
+            if (deleted.First == shared) {
+                opposite = &deleted.Second;
+            } else if (deleted.Second == shared) {
+                opposite = &deleted.First;
+            }
+
+            if (opposite == nullptr || opposite->ComponentId == middle.ComponentId || IsEdgeDeleted({*opposite, middle})) {
+                continue;
+            }
+
+            for (size_t index = 0; index != Graph->ComponentSize(middle.ComponentId); ++index) {
+                auto otherMiddle = TVertex(middle.ComponentId, index);
+                if (otherMiddle != middle && !IsEdgeDeleted({shared, otherMiddle}) && !IsEdgeDeleted({*opposite, otherMiddle})) {
+                    ++answer;
+                }
+            }
+        }
+    }
+
+    return answer;
+}
+
+// quadrangles around the edge itself, all their sides are kept
+INT TDenseGraph::CountGainedI4(const TEdge& edge) const {
+    INT answer = 0;
+    for (size_t middleComponent = 0; middleComponent != Graph->ComponentsNumber(); ++middleComponent) {
+        if (middleComponent == edge.First.ComponentId || middleComponent == edge.Second.ComponentId) {
+            continue;
+        }
+
+        INT common = 0;
+        for (size_t index = 0; index != Graph->ComponentSize(middleComponent); ++index) {
+            auto middle = TVertex(middleComponent, index);
+            if (!IsEdgeDeleted({edge.First, middle}) && !IsEdgeDeleted({edge.Second, middle})) {
+                ++common;
+            }
+        }
+
+        answer += common * (common - 1) / 2;
+    }
+
+    return answer;
+}
+
+// interesting garlands among the subsets of the deleted edges and the new one, which contain the new one
+INT TDenseGraph::CountGarlandsWith(const TEdge& edge) const {
+    INT result = 0;
+    for (auto subset : TSubsetGenerator(EdgeSet.begin(), EdgeSet.end())) {
+        subset.push_back(&edge);
+        if (IsInterestingGarland(subset)) {
+            result += 1;
+        }
+    }
+    return result;
+}
+
 TDenseGraph TDenseGraph::SwapVertices(size_t componentId, size_t firstVertex, size_t secondVertex) const {
     TDenseGraph other(*this);
     other.SwapVerticesInplace(componentId, firstVertex, secondVertex);
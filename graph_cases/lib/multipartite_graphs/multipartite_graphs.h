@@ -1,18 +1,78 @@
 #pragma once
 
 #include "local_types.h"
+#include "complete_graph_tables.h"
 #include "graph.h"
-#include "math_utils/sigma.h"
 
 #include <vector>
 #include <unordered_set>
 #include <memory>
+#include <mutex>
+#include <optional>
 
 
 namespace NMultipartiteGraphs {
+/*
+ * Immutable invariant signature of a complete multipartite graph.
+ * Cheap invariants are computed eagerly on construction, the number
+ * of acyclic orientations is computed once on the first request.
+ * Small graphs take everything from the generated tables, see TCompleteGraphTableEntry.
+ * It is safe to share one signature between threads.
+ */
+class TCompleteGraphSignature {
+public:
+    explicit TCompleteGraphSignature(std::vector<INT> components);
+
+    const std::vector<INT>& Components() const {
+        return Components_;
+    }
+
+    INT VerticesCount() const {
+        return VerticesCount_;
+    }
+
+    INT I2Invariant() const {
+        return I2Invariant_;
+    }
+
+    INT I3Invariant() const {
+        return I3Invariant_;
+    }
+
+    INT I4Invariant() const {
+        return I4Invariant_;
+    }
+
+    INT PtInvariant() const {
+        return PtInvariant_;
+    }
+
+    INT CountAcyclicOrientations() const;
+
+private:
+    TCompleteGraphSignature(std::vector<INT>&& components, const TCompleteGraphTableEntry* tableEntry);
+
+    TCompleteGraphSignature(std::vector<INT>&& components, const TCompleteGraphTableEntry* tableEntry, const std::vector<INT>& sigmas);
+
+    INT ComputeI4() const;
+
+    INT ComputePtInvariant() const;
+
+    const std::vector<INT> Components_;
+    const TCompleteGraphTableEntry* const TableEntry_;
+    const INT VerticesCount_;
+    const INT I2Invariant_;
+    const INT I3Invariant_;
+    const INT I4Invariant_;
+    const INT PtInvariant_;
+
+    mutable std::once_flag AcyclicOrientationsFlag;
+    mutable INT AcyclicOrientations_ = 0;
+};
+
 class TCompleteGraph: public IGraph {
 public:
-    TCompleteGraph() = default;
+    TCompleteGraph();
 
     TCompleteGraph(TCompleteGraph&& other) = default;
 
@@ -22,24 +82,11 @@ public:
 
     TCompleteGraph& operator=(const TCompleteGraph& other) = default;
 
-    explicit TCompleteGraph(std::vector<INT> components)
-        : Components(std::move(components))
-        , I3Invariant_(0)
-        , I4Invariant_(0)
-        , PtInvariant_(0)
-        , AcyclicOrientations_(0)
-        , Edges_(Sigma(2, Components))
-    {
-    }
+    explicit TCompleteGraph(std::vector<INT> components);
 
     template<class TInputIterator>
     TCompleteGraph(TInputIterator begin, TInputIterator end)
-        : Components(begin, end)
-        , I3Invariant_(0)
-        , I4Invariant_(0)
-        , PtInvariant_(0)
-        , AcyclicOrientations_(0)
-        , Edges_(Sigma(2, Components))
+        : TCompleteGraph(std::vector<INT>(begin, end))
     {
     }
 
@@ -56,6 +103,10 @@ public:
 
     INT CountAcyclicOrientations() const override;
 
+    const TCompleteGraphSignature& Signature() const {
+        return *Signature_;
+    }
+
     bool operator==(const TCompleteGraph& other) const;
 
     INT ComponentSize(size_t component) const;
@@ -70,17 +121,8 @@ public:
     std::vector<INT>::const_iterator end() const;
 
 private:
-    INT CalculatePtInvariant() const;
-
-    std::vector<INT> Components;
-    mutable INT I3Invariant_ = 0;
-    mutable INT I4Invariant_ = 0;
-    mutable INT PtInvariant_ = 0;
-    mutable INT AcyclicOrientations_ = 0;
-    INT Edges_ = 0;
-
-
-    INT ComputeI4() const;
+    // copies of the graph share the signature
+    std::shared_ptr<const TCompleteGraphSignature> Signature_;
 };
 }
 
@@ -109,6 +151,9 @@ public:
     TDenseGraph& operator=(TDenseGraph&& other) noexcept {
         Graph = other.Graph;
         EdgeSet = std::move(other.EdgeSet);
+        I3Invariant_ = other.I3Invariant_;
+        I4Invariant_ = other.I4Invariant_;
+        PtInvariant_ = other.PtInvariant_;
         other.Graph = nullptr;
         return *this;
     }
@@ -154,6 +199,16 @@ public:
 
     TDenseGraph SwapVertices(size_t componentId, size_t firstVertex, size_t secondVertex) const;
 
+    /*
+     * Deletes one more edge (which must not be deleted yet).
+     * Cached I4 and PT are updated by the change the edge brings, instead of recomputing them,
+     * other cached invariants are dropped.
+     */
+    void DeleteEdgeInplace(const TEdge& edge);
+
+    // a copy with one more deleted edge, which keeps the cached invariants as DeleteEdgeInplace does
+    TDenseGraph DeleteEdge(const TEdge& edge) const;
+
     std::pair<TDenseGraph, std::unique_ptr<TCompleteGraph>> ContractEdge(const TEdge& edge) const;
 
     static TEdgeSet SwapVerticesInSet(const TEdgeSet& edgeSet, size_t componentId, size_t firstVertex, size_t secondVertex);
@@ -164,9 +219,9 @@ private:
     const TCompleteGraph* Graph;
     TEdgeSet EdgeSet;
 
-    mutable INT I3Invariant_ = 0;
-    mutable INT I4Invariant_ = 0;
-    mutable INT PtInvariant_ = 0;
+    mutable std::optional<INT> I3Invariant_;
+    mutable std::optional<INT> I4Invariant_;
+    mutable std::optional<INT> PtInvariant_;
 
     INT ComputePtInvariant() const;
     INT CountGarlands() const;
@@ -177,6 +232,11 @@ private:
 
     INT ComputeI4TwoParts() const;
     INT ComputeI4ThreeParts() const;
+
+    // I4 quadrangles and interesting garlands which appear or disappear when the edge is deleted
+    INT CountLostI4(const TEdge& edge) const;
+    INT CountGainedI4(const TEdge& edge) const;
+    INT CountGarlandsWith(const TEdge& edge) const;
 };
 }
 
@@ -0,0 +1,172 @@
+#include "mapped_writer.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <stdexcept>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace {
+    [[noreturn]] void ThrowErrno(const std::string& what) {
+        throw std::system_error(errno, std::generic_category(), what);
+    }
+}
+
+TMappedRecordWriter::TMappedRecordWriter(const std::string& path, const std::string& header, size_t recordSize, size_t extentBytes)
+    : Fd(::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644))
+    , DataOffset(header.size())
+    , RecordSize(recordSize)
+    , ExtentRecords(std::max<size_t>(extentBytes / std::max<size_t>(recordSize, 1), 1))
+    , PageSize(static_cast<size_t>(sysconf(_SC_PAGESIZE)))
+    , Next(0)
+    , Chunks{}
+    , Mapped{}
+    , SyncFrom(0)
+{
+    if (Fd < 0) {
+        ThrowErrno("can not open " + path);
+    }
+
+    if (RecordSize == 0) {
+        ::close(Fd);
+        throw std::invalid_argument("record size should be positive");
+    }
+
+    for (auto& chunk : Directory) {
+        chunk.store(nullptr, std::memory_order_relaxed);
+    }
+
+    size_t written = 0;
+    while (written < header.size()) {
+        auto result = ::write(Fd, header.data() + written, header.size() - written);
+        if (result < 0) {
+            ::close(Fd);
+            ThrowErrno("can not write header to " + path);
+        }
+
+        written += static_cast<size_t>(result);
+    }
+}
+
+char* TMappedRecordWriter::Claim() {
+    uint64_t index = Next.fetch_add(1, std::memory_order_relaxed);
+    size_t extent = index / ExtentRecords;
+    // 64 MiB extents cover 64 TiB
+    if ((extent >> ChunkBits) >= DirectorySize) {
+        throw std::length_error("mapped output is too large");
+    }
+
+    char* base = nullptr;
+    if (auto* chunk = Directory[extent >> ChunkBits].load(std::memory_order_acquire)) {
+        base = chunk[extent & (ChunkSize - 1)].load(std::memory_order_acquire);
+    }
+
+    if (base == nullptr) {
+        base = MapExtent(extent);
+    }
+
+    return base + (index % ExtentRecords) * RecordSize;
+}
+
+char* TMappedRecordWriter::MapExtent(size_t extent) {
+    std::lock_guard<std::mutex> lock(MapMutex);
+    auto* chunk = Directory[extent >> ChunkBits].load(std::memory_order_relaxed);
+    if (chunk == nullptr) {
+        Chunks.emplace_back(new std::atomic<char*>[ChunkSize]);
+        chunk = Chunks.back().get();
+        for (size_t i = 0; i != ChunkSize; ++i) {
+            chunk[i].store(nullptr, std::memory_order_relaxed);
+        }
+
+        Directory[extent >> ChunkBits].store(chunk, std::memory_order_release);
+    }
+
+    auto& slot = chunk[extent & (ChunkSize - 1)];
+    char* base = slot.load(std::memory_order_relaxed);
+    if (base != nullptr) {
+        return base;
+    }
+
+    uint64_t begin = DataOffset + static_cast<uint64_t>(extent) * ExtentRecords * RecordSize;
+    uint64_t end = begin + static_cast<uint64_t>(ExtentRecords) * RecordSize;
+    off_t size = ::lseek(Fd, 0, SEEK_END);
+    if (size < 0) {
+        ThrowErrno("can not get output size");
+    }
+
+    if (static_cast<uint64_t>(size) < end && ::ftruncate(Fd, static_cast<off_t>(end)) != 0) {
+        ThrowErrno("can not grow output");
+    }
+
+    // mmap offsets must be page aligned
+    uint64_t mapBegin = begin / PageSize * PageSize;
+    size_t length = static_cast<size_t>(end - mapBegin);
+    void* mapping = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, Fd, static_cast<off_t>(mapBegin));
+    if (mapping == MAP_FAILED) {
+        ThrowErrno("can not map output");
+    }
+
+    if (Mapped.size() <= extent) {
+        Mapped.resize(extent + 1);
+    }
+
+    Mapped[extent] = {static_cast<char*>(mapping), length};
+    base = static_cast<char*>(mapping) + (begin - mapBegin);
+    slot.store(base, std::memory_order_release);
+    return base;
+}
+
+void TMappedRecordWriter::Sync() {
+    // slots are claimed in order, later claims never go below the current extent
+    size_t frontier = static_cast<size_t>(Next.load() / ExtentRecords);
+    decltype(Mapped) mapped;
+    {
+        std::lock_guard<std::mutex> lock(MapMutex);
+        if (SyncFrom < Mapped.size()) {
+            mapped.assign(Mapped.begin() + SyncFrom, Mapped.end());
+        }
+    }
+
+    // extents are unmapped only by Finish(), so they stay valid without the lock
+    for (const auto& extent : mapped) {
+        if (extent.Mapping != nullptr && ::msync(extent.Mapping, extent.Length, MS_SYNC) != 0) {
+            ThrowErrno("can not sync output");
+        }
+    }
+
+    SyncFrom = frontier;
+}
+
+void TMappedRecordWriter::Finish() {
+    std::lock_guard<std::mutex> lock(MapMutex);
+    if (Fd < 0) {
+        return;
+    }
+
+    for (const auto& extent : Mapped) {
+        if (extent.Mapping != nullptr) {
+            ::munmap(extent.Mapping, extent.Length);
+        }
+    }
+
+    Mapped.clear();
+    uint64_t size = DataOffset + Next.load() * RecordSize;
+    int result = ::ftruncate(Fd, static_cast<off_t>(size));
+    int error = errno;
+    ::close(Fd);
+    Fd = -1;
+    if (result != 0) {
+        errno = error;
+        ThrowErrno("can not truncate output");
+    }
+}
+
+TMappedRecordWriter::~TMappedRecordWriter() {
+    try {
+        Finish();
+    } catch (...) {
+    }
+}
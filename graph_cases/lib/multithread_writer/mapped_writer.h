@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*
+ * Writes fixed-size records straight into a memory-mapped file.
+ * Workers claim record slots with one atomic increment and fill them in place,
+ * there is no writing thread and no copy. The file grows by extents
+ * of ExtentRecords records, every extent is mapped separately, so slots
+ * never move. The file is cut to the exact size on Finish() or destruction.
+ * Records are stored in claim order, not in the order they are completed.
+ */
+class TMappedRecordWriter {
+public:
+    static constexpr size_t DefaultExtentBytes = 64 << 20;
+
+    TMappedRecordWriter(const std::string& path, const std::string& header, size_t recordSize, size_t extentBytes = DefaultExtentBytes);
+
+    TMappedRecordWriter(const TMappedRecordWriter&) = delete;
+
+    TMappedRecordWriter& operator=(const TMappedRecordWriter&) = delete;
+
+    // slot of RecordSize bytes owned by the caller
+    char* Claim();
+
+    uint64_t Claimed() const {
+        return Next.load(std::memory_order_relaxed);
+    }
+
+    // flushes extents written since the previous Sync() to disk, records still being filled may be partial;
+    // workers mapping new extents are not blocked meanwhile, must not race with Finish() or another Sync()
+    void Sync();
+
+    // truncates the file to the claimed records and closes it, no Claim() after it
+    void Finish();
+
+    ~TMappedRecordWriter();
+
+private:
+    char* MapExtent(size_t extent);
+
+    struct TExtent {
+        char* Mapping = nullptr;
+        size_t Length = 0;
+    };
+
+    // extent bases are kept in chunks allocated on demand, the directory is fixed
+    static constexpr size_t ChunkBits = 10;
+    static constexpr size_t ChunkSize = size_t(1) << ChunkBits;
+    static constexpr size_t DirectorySize = 1024;
+
+    using TChunk = std::atomic<char*>[];
+
+    int Fd;
+    const uint64_t DataOffset;
+    const size_t RecordSize;
+    const size_t ExtentRecords;
+    const size_t PageSize;
+    std::atomic<uint64_t> Next;
+    std::atomic<std::atomic<char*>*> Directory[DirectorySize];
+    std::vector<std::unique_ptr<TChunk>> Chunks;
+    // indexed by extent, holes are not mapped yet
+    std::vector<TExtent> Mapped;
+    std::mutex MapMutex;
+    // extents below it hold no records claimed after the previous Sync()
+    size_t SyncFrom;
+};
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <charconv>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+/*
+ * Append-only text buffer.
+ * Integers are formatted with std::to_chars, without locales or stream state.
+ */
+class TOutputBuffer {
+public:
+    TOutputBuffer& operator<<(std::string_view s) {
+        Data.append(s);
+        return *this;
+    }
+
+    TOutputBuffer& operator<<(const std::string& s) {
+        Data.append(s);
+        return *this;
+    }
+
+    TOutputBuffer& operator<<(const char* s) {
+        Data.append(s);
+        return *this;
+    }
+
+    TOutputBuffer& operator<<(char c) {
+        Data.push_back(c);
+        return *this;
+    }
+
+    template<typename T, typename = std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, char> && !std::is_same_v<T, bool>>>
+    TOutputBuffer& operator<<(T value) {
+        char buffer[24];
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        Data.append(buffer, result.ptr);
+        return *this;
+    }
+
+    size_t Size() const {
+        return Data.size();
+    }
+
+    bool Empty() const {
+        return Data.empty();
+    }
+
+    const std::string& Str() const {
+        return Data;
+    }
+
+    void Reserve(size_t size) {
+        Data.reserve(size);
+    }
+
+    // returns the content and leaves the buffer empty
+    std::string Take() {
+        std::string result;
+        result.swap(Data);
+        return result;
+    }
+
+private:
+    std::string Data;
+};
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "executer/cancellation.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+/*
+ * Restores the order of blocks produced out of order.
+ * Every block carries a sequence number, blocks are passed to the sink
+ * (anything with Push(std::string&&)) strictly in sequence order.
+ * At most Window blocks are kept: the producer calls WaitForSlot() before
+ * handing out a sequence number, workers never block in Push(), so a worker
+ * never waits for a block which is still queued behind it.
+ */
+template<typename TSink>
+class TReorderBuffer {
+public:
+    TReorderBuffer(TSink& sink, size_t window)
+        : Sink(sink)
+        , Blocks(window == 0 ? 1 : window)
+    {
+    }
+
+    bool HasSlot(uint64_t sequence) const {
+        std::lock_guard<std::mutex> lock(Mutex);
+        return sequence < Next + Blocks.size();
+    }
+
+    // returns false if the wait was cancelled
+    bool WaitForSlot(uint64_t sequence, const TCancellationToken* cancellation = nullptr) {
+        std::unique_lock<std::mutex> lock(Mutex);
+        while (sequence >= Next + Blocks.size()) {
+            if (cancellation && cancellation->IsCancelled()) {
+                return false;
+            }
+
+            // cancellation does not notify us, so poll it
+            SlotAvailable.wait_for(lock, std::chrono::milliseconds(100));
+        }
+
+        return true;
+    }
+
+    void Push(uint64_t sequence, std::string&& block) {
+        std::lock_guard<std::mutex> lock(Mutex);
+        Blocks[sequence % Blocks.size()] = std::move(block);
+        bool emitted = false;
+        while (auto& next = Blocks[Next % Blocks.size()]) {
+            Sink.Push(std::move(*next));
+            next.reset();
+            ++Next;
+            emitted = true;
+        }
+
+        if (emitted) {
+            SlotAvailable.notify_all();
+        }
+    }
+
+    // emits whatever is left in sequence order, skipping the missing blocks
+    void Finish() {
+        std::lock_guard<std::mutex> lock(Mutex);
+        for (size_t i = 0; i != Blocks.size(); ++i) {
+            auto& block = Blocks[(Next + i) % Blocks.size()];
+            if (block) {
+                Sink.Push(std::move(*block));
+                block.reset();
+            }
+        }
+    }
+
+private:
+    TSink& Sink;
+    std::vector<std::optional<std::string>> Blocks;
+    uint64_t Next = 0;
+    mutable std::mutex Mutex;
+    std::condition_variable SlotAvailable;
+};
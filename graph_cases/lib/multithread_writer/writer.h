@@ -1,25 +1,81 @@
 #pragma once
 
+#include "output_buffer.h"
+
 #include "executer/multithread_executer.h"
+#include "executer/parallel_reducer.h"
 
 #include <iostream>
+#include <string>
 
-class TWriter {
+/*
+ * Writes text produced by many threads to the stream from a single thread.
+ * Either push ready strings, or format records into the lane of the calling
+ * thread and Commit() them: a lane is handed off to the writing thread only
+ * once it holds BlockSize bytes, so the stream gets a few large writes.
+ * Lanes are addressed by the worker index of the executer given as workers,
+ * like TParallelReducer slots, a thread which is not its worker gets the shared lane.
+ * The queue in front of the writing thread is a template parameter.
+ */
+template<template<typename> class TQueue>
+class TBasicWriter {
 public:
-    explicit TWriter(std::ostream& out)
+    static constexpr size_t DefaultBlockSize = 64 * 1024;
+
+    explicit TBasicWriter(std::ostream& out, const IExecuter* workers = nullptr, size_t blockSize = DefaultBlockSize)
         : Out(out)
+        , Lanes(workers, TOutputBuffer())
+        , BlockSize(blockSize)
         , Executer(1, 1000, nullptr)
     {
     }
 
-    void Push(std::string&& tokens);
+    TBasicWriter(const TBasicWriter&) = delete;
 
-    ~TWriter();
+    TBasicWriter& operator=(const TBasicWriter&) = delete;
+
+    void Push(std::string&& tokens) {
+        Executer.Add(CreateTask([&out = Out, s = std::move(tokens)]() {
+            out.write(s.data(), s.size());
+        }));
+    }
+
+    TOutputBuffer& Lane() {
+        return Lanes.Local();
+    }
+
+    // call after every complete record written to the lane
+    void Commit(TOutputBuffer& lane) {
+        if (lane.Size() >= BlockSize) {
+            Push(lane.Take());
+            lane.Reserve(BlockSize + BlockSize / 4);
+        }
+    }
+
+    // hands off every lane, must not race with threads writing to lanes
+    void Flush() {
+        Lanes.ForEachLocal([this](TOutputBuffer& lane) {
+            if (!lane.Empty()) {
+                Push(lane.Take());
+            }
+        });
+    }
+
+    ~TBasicWriter() {
+        Flush();
+    }
 
 private:
     std::ostream& Out;
-    TMultiThreadExecuter Executer;
+    TParallelReducer<TOutputBuffer> Lanes;
+    size_t BlockSize;
+    TBasicMultiThreadExecuter<TQueue> Executer;
 };
 
+using TWriter = TBasicWriter<TMultiThreadQueue>;
+
+using TLockFreeWriter = TBasicWriter<TLockFreeQueue>;
 
+extern template class TBasicWriter<TMultiThreadQueue>;
 
+extern template class TBasicWriter<TLockFreeQueue>;
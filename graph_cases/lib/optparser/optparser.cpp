@@ -18,4 +18,8 @@ void FromString(const char * option, unsigned long& l) {
 
 void FromString(const char * option, bool& target) {
     target = std::strcmp(option, "true") == 0;
-}
\ No newline at end of file
+}
+
+void FromString(const char * option, double& d) {
+    d = std::atof(option);
+}
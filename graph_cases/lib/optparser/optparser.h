@@ -8,6 +8,7 @@
 #include <unordered_map>
 #include <vector>
 #include <memory>
+#include <optional>
 
 
 class TBadOptionException : public std::invalid_argument {
@@ -33,6 +34,8 @@ void FromString(const char * option, unsigned long& l);
 
 void FromString(const char * option, bool& target);
 
+void FromString(const char * option, double& d);
+
 struct IHandler {
     virtual ~IHandler() = default;
 
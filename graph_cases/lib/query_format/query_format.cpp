@@ -0,0 +1,181 @@
+#include "query_format.h"
+
+#include "result_format/result_format.h"
+
+#include <charconv>
+#include <stdexcept>
+#include <string>
+
+namespace NQueryFormat {
+    namespace {
+        bool IsSpace(char c) {
+            return c == ' ' || c == '\t' || c == '\r';
+        }
+
+        // appends numbers of the line to result
+        template<typename TNumber>
+        void ParseNumbers(std::string_view line, std::vector<TNumber>& result) {
+            const char* pos = line.data();
+            const char* end = line.data() + line.size();
+            while (true) {
+                while (pos != end && IsSpace(*pos)) {
+                    ++pos;
+                }
+
+                if (pos == end) {
+                    return;
+                }
+
+                const char* tokenEnd = pos;
+                while (tokenEnd != end && !IsSpace(*tokenEnd)) {
+                    ++tokenEnd;
+                }
+
+                TNumber number;
+                auto parsed = std::from_chars(pos, tokenEnd, number);
+                if (parsed.ec != std::errc() || parsed.ptr != tokenEnd) {
+                    throw std::runtime_error("bad token: " + std::string(pos, tokenEnd));
+                }
+
+                result.push_back(number);
+                pos = tokenEnd;
+            }
+        }
+    }
+
+    void WriteHeader(TOutputBuffer& out) {
+        out << std::string_view(Magic, sizeof(Magic));
+        NResultFormat::AppendVarint(out, Version);
+    }
+
+    void WriteQuery(TOutputBuffer& out, const TQuery& query) {
+        NResultFormat::AppendVarint(out, query.Components.size());
+        for (auto component : query.Components) {
+            NResultFormat::AppendVarint(out, component);
+        }
+
+        NResultFormat::AppendVarint(out, query.Edges.size());
+        for (const auto& edge : query.Edges) {
+            NResultFormat::AppendVarint(out, edge.First.ComponentId);
+            NResultFormat::AppendVarint(out, edge.First.VertexId);
+            NResultFormat::AppendVarint(out, edge.Second.ComponentId);
+            NResultFormat::AppendVarint(out, edge.Second.VertexId);
+        }
+    }
+
+    TQueryReader::TQueryReader(std::string_view data)
+        : Pos(data.data())
+        , End(data.data() + data.size())
+        , Binary(data.substr(0, sizeof(Magic)) == std::string_view(Magic, sizeof(Magic)))
+    {
+        if (Binary) {
+            Pos += sizeof(Magic);
+            if (ReadVarint() != Version) {
+                throw std::runtime_error("unsupported queries version");
+            }
+        }
+    }
+
+    bool TQueryReader::Next(TQuery& query) {
+        query.Components.clear();
+        query.Edges.clear();
+        return Binary ? NextBinary(query) : NextText(query);
+    }
+
+    bool TQueryReader::NextText(TQuery& query) {
+        std::string_view line;
+        if (!NextNonEmptyLine(line) || line == "exit") {
+            return false;
+        }
+
+        ParseNumbers(line, query.Components);
+
+        auto& numbers = Numbers;
+        numbers.clear();
+        if (!NextNonEmptyLine(line)) {
+            throw std::runtime_error("unexpected end of queries");
+        }
+
+        ParseNumbers(line, numbers);
+        if (numbers.size() != 1) {
+            throw std::runtime_error("expected the number of edges: " + std::string(line));
+        }
+
+        size_t edgeCount = numbers.front();
+        while (query.Edges.size() != edgeCount) {
+            if (!NextNonEmptyLine(line)) {
+                throw std::runtime_error("unexpected end of queries");
+            }
+
+            numbers.clear();
+            ParseNumbers(line, numbers);
+            // the same as the interactive input, lines of a wrong length are skipped
+            if (numbers.size() != 4) {
+                continue;
+            }
+
+            query.Edges.emplace_back(NMultipartiteGraphs::TVertex(numbers[0], numbers[1]), NMultipartiteGraphs::TVertex(numbers[2], numbers[3]));
+        }
+
+        return true;
+    }
+
+    bool TQueryReader::NextBinary(TQuery& query) {
+        if (Pos == End) {
+            return false;
+        }
+
+        query.Components.resize(ReadVarint());
+        for (auto& component : query.Components) {
+            component = static_cast<INT>(ReadVarint());
+        }
+
+        query.Edges.resize(ReadVarint());
+        for (auto& edge : query.Edges) {
+            edge.First.ComponentId = ReadVarint();
+            edge.First.VertexId = static_cast<INT>(ReadVarint());
+            edge.Second.ComponentId = ReadVarint();
+            edge.Second.VertexId = static_cast<INT>(ReadVarint());
+        }
+
+        return true;
+    }
+
+    bool TQueryReader::NextNonEmptyLine(std::string_view& line) {
+        while (Pos != End) {
+            const char* lineEnd = Pos;
+            while (lineEnd != End && *lineEnd != '\n') {
+                ++lineEnd;
+            }
+
+            line = std::string_view(Pos, lineEnd - Pos);
+            Pos = lineEnd == End ? End : lineEnd + 1;
+            while (!line.empty() && IsSpace(line.back())) {
+                line.remove_suffix(1);
+            }
+
+            if (!line.empty()) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    uint64_t TQueryReader::ReadVarint() {
+        uint64_t result = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            if (Pos == End) {
+                throw std::runtime_error("unexpected end of queries");
+            }
+
+            uint8_t byte = static_cast<uint8_t>(*Pos++);
+            result |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) {
+                return result;
+            }
+        }
+
+        throw std::runtime_error("varint is too long");
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "local_types.h"
+#include "multipartite_graphs/graph.h"
+#include "multithread_writer/output_buffer.h"
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+/*
+ * Queries of acyclic_orientations_calculator.
+ *
+ * Text: a line with partition sizes (or "exit"), a line with the number
+ * of deleted edges and a line per edge "component index component index".
+ * Binary: magic "CHQB", version, then for every query the number of
+ * components, the components, the number of deleted edges and four numbers
+ * per edge. All integers are LEB128 varints.
+ */
+namespace NQueryFormat {
+    constexpr char Magic[4] = {'C', 'H', 'Q', 'B'};
+    constexpr uint64_t Version = 1;
+
+    struct TQuery {
+        std::vector<INT> Components;
+        std::vector<NMultipartiteGraphs::TEdge> Edges;
+    };
+
+    void WriteHeader(TOutputBuffer& out);
+
+    void WriteQuery(TOutputBuffer& out, const TQuery& query);
+
+    /*
+     * Tokenizes queries of either format in place, the format is detected by the magic.
+     * The memory must outlive the reader. Vectors of the query are reused,
+     * so reading into the same query does not allocate once they are large enough.
+     * Throws std::runtime_error on malformed input.
+     */
+    class TQueryReader {
+    public:
+        explicit TQueryReader(std::string_view data);
+
+        bool IsBinary() const {
+            return Binary;
+        }
+
+        // false at the end of the input or at "exit"
+        bool Next(TQuery& query);
+
+    private:
+        bool NextText(TQuery& query);
+
+        bool NextBinary(TQuery& query);
+
+        bool NextNonEmptyLine(std::string_view& line);
+
+        uint64_t ReadVarint();
+
+        const char* Pos;
+        const char* End;
+        bool Binary;
+        std::vector<size_t> Numbers;
+    };
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+/*
+ * Event count for parking threads after an unsuccessful spin.
+ * A waiter calls PrepareWait, checks its condition once more and then
+ * either CancelWait or Wait. Notify costs a single atomic load while
+ * nobody is parked, the mutex is only touched on the slow path.
+ */
+class TEventCount {
+public:
+    uint64_t PrepareWait() {
+        Waiters.fetch_add(1, std::memory_order_seq_cst);
+        return Epoch.load(std::memory_order_seq_cst);
+    }
+
+    void CancelWait() {
+        Waiters.fetch_sub(1, std::memory_order_seq_cst);
+    }
+
+    void Wait(uint64_t epoch) {
+        {
+            std::unique_lock<std::mutex> lock(Mutex);
+            while (Epoch.load(std::memory_order_relaxed) == epoch) {
+                Condition.wait(lock);
+            }
+        }
+
+        Waiters.fetch_sub(1, std::memory_order_seq_cst);
+    }
+
+    // returns false on timeout
+    template<typename TClock, typename TDuration>
+    bool WaitUntil(uint64_t epoch, const std::chrono::time_point<TClock, TDuration>& deadline) {
+        bool notified = true;
+        {
+            std::unique_lock<std::mutex> lock(Mutex);
+            while (Epoch.load(std::memory_order_relaxed) == epoch) {
+                if (Condition.wait_until(lock, deadline) == std::cv_status::timeout) {
+                    notified = Epoch.load(std::memory_order_relaxed) != epoch;
+                    break;
+                }
+            }
+        }
+
+        Waiters.fetch_sub(1, std::memory_order_seq_cst);
+        return notified;
+    }
+
+    void NotifyAll() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (Waiters.load(std::memory_order_relaxed) == 0) {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(Mutex);
+            Epoch.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        Condition.notify_all();
+    }
+
+private:
+    std::atomic<uint64_t> Epoch{0};
+    std::atomic<uint32_t> Waiters{0};
+    std::mutex Mutex;
+    std::condition_variable Condition;
+};
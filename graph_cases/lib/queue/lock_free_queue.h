@@ -0,0 +1,254 @@
+#pragma once
+
+#include "event_count.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/*
+ * Bounded lock-free MPMC queue (Vyukov's ring with per-cell sequence numbers)
+ * with the interface of TMultiThreadQueue. Blocking operations spin for a while
+ * and then park on an event count, so an uncontended push or pop is a couple
+ * of atomic operations and never takes a lock.
+ * The capacity is rounded up to a power of two, zero means DefaultCapacity.
+ */
+template<typename TType>
+class TLockFreeQueue {
+public:
+    static constexpr size_t DefaultCapacity = 1024;
+
+    TLockFreeQueue(size_t maxSize = 0)
+        : Mask(RoundCapacity(maxSize) - 1)
+        , Cells(new TCell[Mask + 1])
+    {
+        for (size_t i = 0; i <= Mask; ++i) {
+            Cells[i].Sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    TLockFreeQueue(const TLockFreeQueue&) = delete;
+
+    TLockFreeQueue& operator=(const TLockFreeQueue&) = delete;
+
+    ~TLockFreeQueue() {
+        TType item;
+        while (TryPop(item)) {
+        }
+    }
+
+    bool TryPush(TType&& item) {
+        size_t position = EnqueuePosition.load(std::memory_order_relaxed);
+        TCell* cell = nullptr;
+        while (true) {
+            cell = &Cells[position & Mask];
+            size_t sequence = cell->Sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+            if (diff == 0) {
+                if (EnqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                position = EnqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+
+        new (cell->Storage) TType(std::move(item));
+        cell->Sequence.store(position + 1, std::memory_order_release);
+        NonEmpty.NotifyAll();
+        return true;
+    }
+
+    bool TryPop(TType& result) {
+        size_t position = DequeuePosition.load(std::memory_order_relaxed);
+        TCell* cell = nullptr;
+        while (true) {
+            cell = &Cells[position & Mask];
+            size_t sequence = cell->Sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+            if (diff == 0) {
+                if (DequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                position = DequeuePosition.load(std::memory_order_relaxed);
+            }
+        }
+
+        TType* stored = std::launder(reinterpret_cast<TType*>(cell->Storage));
+        result = std::move(*stored);
+        stored->~TType();
+        cell->Sequence.store(position + Mask + 1, std::memory_order_release);
+
+        NonFull.NotifyAll();
+        if (IsEmpty()) {
+            Empty_.NotifyAll();
+        }
+
+        return true;
+    }
+
+    void Push(TType&& item) {
+        if (SpinUntil([&]() { return TryPush(std::move(item)); })) {
+            return;
+        }
+
+        while (true) {
+            auto epoch = NonFull.PrepareWait();
+            if (TryPush(std::move(item))) {
+                NonFull.CancelWait();
+                return;
+            }
+
+            NonFull.Wait(epoch);
+            if (TryPush(std::move(item))) {
+                return;
+            }
+        }
+    }
+
+    void PushMany(std::vector<TType>&& items) {
+        for (auto& item : items) {
+            Push(std::move(item));
+        }
+
+        items.clear();
+    }
+
+    TType Pop() {
+        TType result;
+        if (SpinUntil([&]() { return TryPop(result); })) {
+            return result;
+        }
+
+        while (true) {
+            auto epoch = NonEmpty.PrepareWait();
+            if (TryPop(result)) {
+                NonEmpty.CancelWait();
+                return result;
+            }
+
+            NonEmpty.Wait(epoch);
+            if (TryPop(result)) {
+                return result;
+            }
+        }
+    }
+
+    bool Pop(std::chrono::seconds timeout, TType& result) {
+        if (SpinUntil([&]() { return TryPop(result); })) {
+            return true;
+        }
+
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (true) {
+            auto epoch = NonEmpty.PrepareWait();
+            if (TryPop(result)) {
+                NonEmpty.CancelWait();
+                return true;
+            }
+
+            bool notified = NonEmpty.WaitUntil(epoch, deadline);
+            if (TryPop(result)) {
+                return true;
+            }
+
+            if (!notified) {
+                return false;
+            }
+        }
+    }
+
+    size_t PopMany(std::vector<TType>& result, size_t maxCount) {
+        if (maxCount == 0) {
+            return 0;
+        }
+
+        result.push_back(Pop());
+        size_t count = 1;
+        TType item;
+        while (count != maxCount && TryPop(item)) {
+            result.push_back(std::move(item));
+            ++count;
+        }
+
+        return count;
+    }
+
+    inline bool IsEmpty() const {
+        return Size() == 0;
+    }
+
+    size_t Size() const {
+        size_t dequeued = DequeuePosition.load(std::memory_order_acquire);
+        size_t enqueued = EnqueuePosition.load(std::memory_order_acquire);
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+    }
+
+    size_t Capacity() const {
+        return Mask + 1;
+    }
+
+    void WaitEmpty() {
+        while (true) {
+            auto epoch = Empty_.PrepareWait();
+            if (IsEmpty()) {
+                Empty_.CancelWait();
+                return;
+            }
+
+            Empty_.Wait(epoch);
+        }
+    }
+
+private:
+    static constexpr size_t SpinCount = 128;
+
+    struct TCell {
+        std::atomic<size_t> Sequence;
+        alignas(TType) unsigned char Storage[sizeof(TType)];
+    };
+
+    static size_t RoundCapacity(size_t maxSize) {
+        size_t capacity = 2;
+        while (capacity < (maxSize == 0 ? DefaultCapacity : maxSize)) {
+            capacity <<= 1;
+        }
+
+        return capacity;
+    }
+
+    template<typename TFunc>
+    static bool SpinUntil(TFunc&& func) {
+        for (size_t spin = 0; spin != SpinCount; ++spin) {
+            if (func()) {
+                return true;
+            }
+
+            if (spin >= SpinCount / 2) {
+                std::this_thread::yield();
+            }
+        }
+
+        return false;
+    }
+
+    const size_t Mask;
+    std::unique_ptr<TCell[]> Cells;
+    alignas(64) std::atomic<size_t> EnqueuePosition{0};
+    alignas(64) std::atomic<size_t> DequeuePosition{0};
+    alignas(64) TEventCount NonEmpty;
+    TEventCount NonFull;
+    TEventCount Empty_;
+};
@@ -1,11 +1,14 @@
 #pragma once
 
+#include "ring_buffer.h"
+
+#include <algorithm>
 #include <cassert>
 #include <chrono>
 #include <condition_variable>
-#include <deque>
 #include <mutex>
 #include <thread>
+#include <vector>
 
 #include <iostream>
 
@@ -14,12 +17,13 @@ class TMultiThreadQueue {
 public:
     TMultiThreadQueue(size_t maxSize = 0)
         : MaxSize(maxSize)
+        , Storage(maxSize)
     {
     }
 
     TType Pop() {
         std::unique_lock<std::mutex> lock(Mutex);
-        while (Storage.empty()) {
+        while (Storage.Empty()) {
             NonEmpty.wait(lock);
         }
 
@@ -30,7 +34,7 @@ public:
 
     bool Pop(std::chrono::seconds timeout, TType& result) {
         std::unique_lock<std::mutex> lock(Mutex);
-        while (Storage.empty()) {
+        while (Storage.Empty()) {
             if (NonEmpty.wait_for(lock, timeout) == std::cv_status::timeout) {
                 return false;
             }
@@ -40,20 +44,71 @@ public:
         return true;
     }
 
+    /*
+     * Pops up to maxCount items under a single lock acquisition,
+     * waits until at least one item is available.
+     */
+    size_t PopMany(std::vector<TType>& result, size_t maxCount) {
+        std::unique_lock<std::mutex> lock(Mutex);
+        while (Storage.Empty()) {
+            NonEmpty.wait(lock);
+        }
+
+        size_t count = std::min(maxCount, Storage.Size());
+        for (size_t i = 0; i != count; ++i) {
+            result.push_back(std::move(Storage.Front()));
+            Storage.PopFront();
+        }
+
+        OnPopped();
+        return count;
+    }
+
     void Push(TType&& item) {
         std::unique_lock<std::mutex> lock(Mutex);
         if (MaxSize != 0) {
-            while (Storage.size() >= MaxSize) {
+            while (Storage.Size() >= MaxSize) {
                 Pushable.wait(lock);
             }
         };
 
-        Storage.push_back(std::move(item));
+        Storage.PushBack(std::move(item));
         NonEmpty.notify_one();
     }
 
+    /*
+     * Pushes all the items, taking the lock once per portion
+     * which fits into the queue instead of once per item.
+     */
+    void PushMany(std::vector<TType>&& items) {
+        auto iter = items.begin();
+        while (iter != items.end()) {
+            std::unique_lock<std::mutex> lock(Mutex);
+            size_t count = static_cast<size_t>(items.end() - iter);
+            if (MaxSize != 0) {
+                while (Storage.Size() >= MaxSize) {
+                    Pushable.wait(lock);
+                }
+
+                count = std::min(count, MaxSize - Storage.Size());
+            }
+
+            for (size_t i = 0; i != count; ++i, ++iter) {
+                Storage.PushBack(std::move(*iter));
+            }
+
+            if (count == 1) {
+                NonEmpty.notify_one();
+            } else {
+                NonEmpty.notify_all();
+            }
+        }
+
+        items.clear();
+    }
+
     inline bool IsEmpty() const {
-        return Storage.empty();
+        return Storage.Empty();
     }
 
     std::condition_variable& Empty() {
@@ -62,32 +117,36 @@ public:
 
     size_t Size() const {
         std::unique_lock<std::mutex> lock(Mutex);
-        return Storage.size();
+        return Storage.Size();
     }
 
     void WaitEmpty() {
         std::unique_lock<std::mutex> lock(Mutex);
-        while (!Storage.empty()) {
+        while (!Storage.Empty()) {
             Empty_.wait(lock);
         }
     }
 
 private:
     void DoPop(TType& result){
-        assert(!Storage.empty() && "empty storage");
-        result = std::move(Storage.front());
-        Storage.pop_front();
-        if (Storage.empty()) {
+        assert(!Storage.Empty() && "empty storage");
+        result = std::move(Storage.Front());
+        Storage.PopFront();
+        OnPopped();
+    }
+
+    void OnPopped() {
+        if (Storage.Empty()) {
             Empty_.notify_all();
         }
 
-        if (Storage.size() < MaxSize) {
+        if (Storage.Size() < MaxSize) {
             Pushable.notify_one();
         }
     }
 
     size_t MaxSize;
-    std::deque<TType> Storage;
+    TRingBuffer<TType> Storage;
     mutable std::mutex Mutex;
     std::condition_variable NonEmpty;
     std::condition_variable Empty_;
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <optional>
+#include <utility>
+#include <vector>
+
+/*
+ * FIFO storage on a preallocated circular array.
+ * Items are kept by value, the array grows twice when it is full,
+ * so a buffer created with enough capacity never allocates again.
+ */
+template<typename TType>
+class TRingBuffer {
+public:
+    explicit TRingBuffer(size_t capacity = 0)
+        : Slots(capacity)
+    {
+    }
+
+    bool Empty() const {
+        return Count == 0;
+    }
+
+    size_t Size() const {
+        return Count;
+    }
+
+    size_t Capacity() const {
+        return Slots.size();
+    }
+
+    TType& Front() {
+        assert(Count != 0 && "empty ring buffer");
+        return *Slots[Head];
+    }
+
+    void PopFront() {
+        assert(Count != 0 && "empty ring buffer");
+        Slots[Head].reset();
+        Head = Next(Head);
+        --Count;
+    }
+
+    void PushBack(TType&& item) {
+        if (Count == Slots.size()) {
+            Grow();
+        }
+
+        size_t tail = Head + Count;
+        if (tail >= Slots.size()) {
+            tail -= Slots.size();
+        }
+
+        Slots[tail].emplace(std::move(item));
+        ++Count;
+    }
+
+private:
+    size_t Next(size_t index) const {
+        return (index + 1 == Slots.size()) ? 0 : index + 1;
+    }
+
+    void Grow() {
+        std::vector<std::optional<TType>> slots(Slots.empty() ? 16 : Slots.size() * 2);
+        for (size_t i = 0; i != Count; ++i) {
+            slots[i].emplace(std::move(*Slots[Head]));
+            Slots[Head].reset();
+            Head = Next(Head);
+        }
+
+        Slots.swap(slots);
+        Head = 0;
+    }
+
+    std::vector<std::optional<TType>> Slots;
+    size_t Head = 0;
+    size_t Count = 0;
+};
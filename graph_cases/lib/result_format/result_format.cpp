@@ -0,0 +1,257 @@
+#include "result_format.h"
+
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+namespace NResultFormat {
+    namespace {
+        enum EFlags : uint8_t {
+            FlagWriteEdgeSet = 1,
+            FlagComputeAll = 2,
+            FlagFixedWidth = 4,
+        };
+
+        void StoreLittleEndian(char* out, uint64_t value) {
+            for (size_t i = 0; i != sizeof(value); ++i) {
+                out[i] = static_cast<char>(value >> (8 * i));
+            }
+        }
+
+        uint64_t LoadLittleEndian(const char* in) {
+            uint64_t result = 0;
+            for (size_t i = 0; i != sizeof(result); ++i) {
+                result |= static_cast<uint64_t>(static_cast<uint8_t>(in[i])) << (8 * i);
+            }
+
+            return result;
+        }
+
+        void AppendGraph(TOutputBuffer& out, const std::vector<INT>& components) {
+            AppendVarint(out, components.size());
+            for (auto component : components) {
+                AppendVarint(out, component);
+            }
+        }
+
+        uint8_t ReadByte(std::istream& in) {
+            char c;
+            if (!in.get(c)) {
+                throw std::runtime_error("unexpected end of results");
+            }
+
+            return static_cast<uint8_t>(c);
+        }
+
+        uint64_t ReadVarint(std::istream& in) {
+            uint64_t result = 0;
+            for (unsigned shift = 0; shift < 64; shift += 7) {
+                uint8_t byte = ReadByte(in);
+                result |= static_cast<uint64_t>(byte & 0x7f) << shift;
+                if ((byte & 0x80) == 0) {
+                    return result;
+                }
+            }
+
+            throw std::runtime_error("varint is too long");
+        }
+
+        std::vector<INT> ReadGraph(std::istream& in) {
+            std::vector<INT> result(ReadVarint(in));
+            for (auto& component : result) {
+                component = static_cast<INT>(ReadVarint(in));
+            }
+
+            return result;
+        }
+    }
+
+    void AppendVarint(TOutputBuffer& out, uint64_t value) {
+        while (value >= 0x80) {
+            out << static_cast<char>((value & 0x7f) | 0x80);
+            value >>= 7;
+        }
+
+        out << static_cast<char>(value);
+    }
+
+    void WriteHeader(TOutputBuffer& out, const THeader& header) {
+        out << std::string_view(Magic, sizeof(Magic));
+        AppendVarint(out, Version);
+        uint8_t flags = (header.WriteEdgeSet ? FlagWriteEdgeSet : 0) | (header.ComputeAll ? FlagComputeAll : 0) | (header.FixedWidth ? FlagFixedWidth : 0);
+        out << static_cast<char>(flags);
+        AppendGraph(out, header.Source);
+        AppendGraph(out, header.Target);
+        AppendVarint(out, header.DeletedEdges);
+        AppendVarint(out, header.Checkers.size());
+        for (const auto& name : header.Checkers) {
+            AppendVarint(out, name.size());
+            out << name;
+        }
+    }
+
+    void WriteRecord(TOutputBuffer& out, uint64_t rank, uint8_t verdict, const uint64_t* values, size_t count) {
+        AppendVarint(out, rank);
+        out << static_cast<char>(verdict);
+        AppendVarint(out, count);
+        for (size_t i = 0; i != count; ++i) {
+            AppendVarint(out, values[i]);
+        }
+    }
+
+    size_t FixedRecordSize(size_t checkersCount) {
+        return sizeof(uint64_t) + 2 + checkersCount * sizeof(uint64_t);
+    }
+
+    void WriteFixedRecord(char* slot, size_t checkersCount, uint64_t rank, uint8_t verdict, const uint64_t* values, size_t count) {
+        StoreLittleEndian(slot, rank);
+        slot[sizeof(uint64_t)] = static_cast<char>(verdict);
+        slot[sizeof(uint64_t) + 1] = static_cast<char>(count);
+        char* out = slot + sizeof(uint64_t) + 2;
+        for (size_t i = 0; i != checkersCount; ++i) {
+            StoreLittleEndian(out + i * sizeof(uint64_t), i < count ? values[i] : 0);
+        }
+    }
+
+    TReader::TReader(std::istream& in)
+        : In(in)
+    {
+        char magic[sizeof(Magic)];
+        if (!In.read(magic, sizeof(magic)) || std::string_view(magic, sizeof(magic)) != std::string_view(Magic, sizeof(Magic))) {
+            throw std::runtime_error("not a binary results stream");
+        }
+
+        if (ReadVarint(In) != Version) {
+            throw std::runtime_error("unsupported results version");
+        }
+
+        uint8_t flags = ReadByte(In);
+        Header_.WriteEdgeSet = (flags & FlagWriteEdgeSet) != 0;
+        Header_.ComputeAll = (flags & FlagComputeAll) != 0;
+        Header_.FixedWidth = (flags & FlagFixedWidth) != 0;
+        Header_.Source = ReadGraph(In);
+        Header_.Target = ReadGraph(In);
+        Header_.DeletedEdges = ReadVarint(In);
+        Header_.Checkers.resize(ReadVarint(In));
+        for (auto& name : Header_.Checkers) {
+            name.resize(ReadVarint(In));
+            if (!In.read(name.data(), name.size())) {
+                throw std::runtime_error("unexpected end of results");
+            }
+        }
+    }
+
+    bool TReader::Next(TRecord& record) {
+        if (In.peek() == std::istream::traits_type::eof()) {
+            return false;
+        }
+
+        if (Header_.FixedWidth) {
+            return NextFixed(record);
+        }
+
+        record.Rank = ReadVarint(In);
+        record.Verdict = ReadByte(In);
+        record.Values.resize(ReadVarint(In));
+        for (auto& value : record.Values) {
+            value = ReadVarint(In);
+        }
+
+        if (record.Verdict > Header_.Checkers.size() || record.Values.size() > Header_.Checkers.size()) {
+            throw std::runtime_error("malformed result record");
+        }
+
+        return true;
+    }
+
+    bool TReader::NextFixed(TRecord& record) {
+        std::string buffer(FixedRecordSize(Header_.Checkers.size()), '\0');
+        if (!In.read(buffer.data(), buffer.size())) {
+            throw std::runtime_error("unexpected end of results");
+        }
+
+        record.Rank = LoadLittleEndian(buffer.data());
+        record.Verdict = static_cast<uint8_t>(buffer[sizeof(uint64_t)]);
+        size_t count = static_cast<uint8_t>(buffer[sizeof(uint64_t) + 1]);
+        if (record.Verdict > Header_.Checkers.size() || count > Header_.Checkers.size()) {
+            throw std::runtime_error("malformed result record");
+        }
+
+        record.Values.resize(count);
+        for (size_t i = 0; i != count; ++i) {
+            record.Values[i] = LoadLittleEndian(buffer.data() + sizeof(uint64_t) + 2 + i * sizeof(uint64_t));
+        }
+
+        return true;
+    }
+
+    void WriteText(TOutputBuffer& out, const THeader& header, size_t componentsNumber, const NMultipartiteGraphs::TEdgeSet& deletedEdges, uint8_t verdict, const uint64_t* values, size_t count) {
+        if (header.WriteEdgeSet) {
+            for (const auto& edge : deletedEdges) {
+                out << edge << ' ';
+            }
+        }
+
+        for (size_t i = 0; i != count; ++i) {
+            out << header.Checkers[i] << ": " << values[i] << ' ';
+        }
+
+        if (verdict == Match) {
+            out << "Answer: YES";
+        } else {
+            out << "Answer: NO Reason: " << header.Checkers[verdict - 1];
+        }
+
+        out << ' ';
+        WriteEdgeStat(componentsNumber, deletedEdges, out);
+        out << '\n';
+    }
+
+    std::vector<uint64_t> ComputeEdgeStat(size_t componentsNumber, const NMultipartiteGraphs::TEdgeSet& edgeSet) {
+        std::vector<std::vector<uint64_t>> edgeStat(componentsNumber, std::vector<uint64_t>(componentsNumber, 0));
+
+        for (const auto& edge: edgeSet) {
+            auto firstComponent = edge.First.ComponentId;
+            auto secondComponent = edge.Second.ComponentId;
+            if (firstComponent > secondComponent) {
+                std::swap(firstComponent, secondComponent);
+            }
+
+            edgeStat[firstComponent][secondComponent] += 1;
+        }
+
+        std::vector<uint64_t> result;
+        for (size_t i = 0; i + 1 < componentsNumber; ++i) {
+            for (size_t j = i + 1; j != componentsNumber; ++j) {
+                result.push_back(edgeStat[i][j]);
+            }
+        }
+
+        return result;
+    }
+
+    void WriteEdgeStat(size_t componentsNumber, const std::vector<uint64_t>& edgeStat, TOutputBuffer& out) {
+        size_t index = 0;
+        for (size_t i = 0; i + 1 < componentsNumber; ++i) {
+            for (size_t j = i + 1; j != componentsNumber; ++j) {
+                if (index != 0) {
+                    out << ", ";
+                }
+                out << 'e' << i + 1 << j + 1 << '=' << edgeStat[index];
+                ++index;
+            }
+        }
+    }
+
+    void WriteEdgeStat(size_t componentsNumber, const NMultipartiteGraphs::TEdgeSet& edgeSet, TOutputBuffer& out) {
+        WriteEdgeStat(componentsNumber, ComputeEdgeStat(componentsNumber, edgeSet), out);
+    }
+}
+
+TOutputBuffer& operator<<(TOutputBuffer& out, const NMultipartiteGraphs::TVertex& node) {
+    return out << "TNode(" << node.ComponentId << ", " << node.VertexId << ")";
+}
+
+TOutputBuffer& operator<<(TOutputBuffer& out, const NMultipartiteGraphs::TEdge& edge) {
+    return out << "TEdge(" << edge.First << ", " << edge.Second << ")";
+}
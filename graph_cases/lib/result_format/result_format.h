@@ -0,0 +1,98 @@
+#pragma once
+
+#include "local_types.h"
+#include "multipartite_graphs/multipartite_graphs.h"
+#include "multithread_writer/output_buffer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+/*
+ * Binary format of graph_cases results.
+ *
+ * Header: magic "CHRB", version, flags, source and target graph components,
+ * number of deleted edges and checker names.
+ * Record: rank of the deleted edge combination (see CombinationRank over
+ * target.GenerateAllEdges()), verdict byte, number of computed values and the values.
+ * All integers are LEB128 varints.
+ *
+ * Fixed-width records (FixedWidth in the header) keep the same header,
+ * every record then takes FixedRecordSize bytes: little-endian 64-bit rank,
+ * verdict byte, number of computed values and 64-bit little-endian values
+ * for every checker, unused values are zero.
+ */
+namespace NResultFormat {
+    constexpr char Magic[4] = {'C', 'H', 'R', 'B'};
+    constexpr uint64_t Version = 1;
+
+    // every checker passed, otherwise the verdict is 1 + index of the first failed checker
+    constexpr uint8_t Match = 0;
+
+    struct THeader {
+        std::vector<INT> Source;
+        std::vector<INT> Target;
+        uint64_t DeletedEdges = 0;
+        std::vector<std::string> Checkers;
+        bool WriteEdgeSet = false;
+        bool ComputeAll = false;
+        bool FixedWidth = false;
+    };
+
+    struct TRecord {
+        uint64_t Rank = 0;
+        uint8_t Verdict = Match;
+        std::vector<uint64_t> Values;
+    };
+
+    void AppendVarint(TOutputBuffer& out, uint64_t value);
+
+    void WriteHeader(TOutputBuffer& out, const THeader& header);
+
+    void WriteRecord(TOutputBuffer& out, uint64_t rank, uint8_t verdict, const uint64_t* values, size_t count);
+
+    size_t FixedRecordSize(size_t checkersCount);
+
+    // fills FixedRecordSize(checkersCount) bytes at slot
+    void WriteFixedRecord(char* slot, size_t checkersCount, uint64_t rank, uint8_t verdict, const uint64_t* values, size_t count);
+
+    /*
+     * Reads a binary result stream, throws std::runtime_error on malformed input.
+     */
+    class TReader {
+    public:
+        explicit TReader(std::istream& in);
+
+        const THeader& Header() const {
+            return Header_;
+        }
+
+        // false at the end of the stream
+        bool Next(TRecord& record);
+
+    private:
+        bool NextFixed(TRecord& record);
+
+        std::istream& In;
+        THeader Header_;
+    };
+
+    /*
+     * Text line of a candidate, the same graph_cases writes in the text format:
+     * deleted edges (if requested), checker values, the answer and edge statistics.
+     */
+    void WriteText(TOutputBuffer& out, const THeader& header, size_t componentsNumber, const NMultipartiteGraphs::TEdgeSet& deletedEdges, uint8_t verdict, const uint64_t* values, size_t count);
+
+    // deleted edges between components i < j, in the order e12, e13, ..., e23, ...
+    std::vector<uint64_t> ComputeEdgeStat(size_t componentsNumber, const NMultipartiteGraphs::TEdgeSet& edgeSet);
+
+    void WriteEdgeStat(size_t componentsNumber, const std::vector<uint64_t>& edgeStat, TOutputBuffer& out);
+
+    void WriteEdgeStat(size_t componentsNumber, const NMultipartiteGraphs::TEdgeSet& edgeSet, TOutputBuffer& out);
+}
+
+TOutputBuffer& operator<<(TOutputBuffer& out, const NMultipartiteGraphs::TVertex& node);
+
+TOutputBuffer& operator<<(TOutputBuffer& out, const NMultipartiteGraphs::TEdge& edge);
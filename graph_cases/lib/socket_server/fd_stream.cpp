@@ -0,0 +1,74 @@
+#include "fd_stream.h"
+
+#include <cerrno>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+TFdStreamBuf::TFdStreamBuf(int fd, size_t bufferSize)
+    : Fd(fd)
+    , Input(bufferSize)
+    , Output(bufferSize)
+{
+    setg(Input.data(), Input.data(), Input.data());
+    setp(Output.data(), Output.data() + Output.size());
+}
+
+TFdStreamBuf::~TFdStreamBuf() {
+    FlushOutput();
+}
+
+TFdStreamBuf::int_type TFdStreamBuf::underflow() {
+    if (gptr() < egptr()) {
+        return traits_type::to_int_type(*gptr());
+    }
+
+    ssize_t result;
+    do {
+        result = ::read(Fd, Input.data(), Input.size());
+    } while (result < 0 && errno == EINTR);
+
+    if (result <= 0) {
+        return traits_type::eof();
+    }
+
+    setg(Input.data(), Input.data(), Input.data() + result);
+    return traits_type::to_int_type(*gptr());
+}
+
+TFdStreamBuf::int_type TFdStreamBuf::overflow(int_type c) {
+    if (!FlushOutput()) {
+        return traits_type::eof();
+    }
+
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+    }
+
+    return traits_type::not_eof(c);
+}
+
+int TFdStreamBuf::sync() {
+    return FlushOutput() ? 0 : -1;
+}
+
+bool TFdStreamBuf::FlushOutput() {
+    const char* pos = pbase();
+    while (pos < pptr()) {
+        ssize_t result = ::send(Fd, pos, pptr() - pos, MSG_NOSIGNAL);
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (result <= 0) {
+            setp(Output.data(), Output.data() + Output.size());
+            return false;
+        }
+
+        pos += result;
+    }
+
+    setp(Output.data(), Output.data() + Output.size());
+    return true;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <streambuf>
+#include <vector>
+
+/*
+ * Buffered stream buffer over a connected socket descriptor.
+ * Writes do not raise SIGPIPE, a closed peer fails the stream instead.
+ * The descriptor is not owned.
+ */
+class TFdStreamBuf : public std::streambuf {
+public:
+    explicit TFdStreamBuf(int fd, size_t bufferSize = 64 * 1024);
+
+    TFdStreamBuf(const TFdStreamBuf&) = delete;
+
+    TFdStreamBuf& operator=(const TFdStreamBuf&) = delete;
+
+    ~TFdStreamBuf() override;
+
+protected:
+    int_type underflow() override;
+
+    int_type overflow(int_type c) override;
+
+    int sync() override;
+
+private:
+    bool FlushOutput();
+
+    int Fd;
+    std::vector<char> Input;
+    std::vector<char> Output;
+};
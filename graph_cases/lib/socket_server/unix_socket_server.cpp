@@ -0,0 +1,157 @@
+#include "unix_socket_server.h"
+
+#include "fd_stream.h"
+
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+#include <system_error>
+
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+    sockaddr_un MakeAddress(const std::string& path) {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path)) {
+            throw std::invalid_argument("socket path is too long: " + path);
+        }
+
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+        return address;
+    }
+
+    [[noreturn]] void ThrowErrno(int fd, const std::string& what) {
+        int error = errno;
+        if (fd >= 0) {
+            ::close(fd);
+        }
+
+        throw std::system_error(error, std::generic_category(), what);
+    }
+}
+
+TUnixSocketServer::TUnixSocketServer(std::string path, int backlog, std::chrono::milliseconds idleTimeout)
+    : Path(std::move(path))
+    , IdleTimeout(idleTimeout)
+    , ListenFd(-1)
+    , Stopped(false)
+    , Connections{}
+    , ConnectionsMutex{}
+{
+    auto address = MakeAddress(Path);
+    ListenFd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (ListenFd < 0) {
+        ThrowErrno(-1, "can not create socket");
+    }
+
+    ::unlink(Path.c_str());
+    if (::bind(ListenFd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        ThrowErrno(ListenFd, "can not bind " + Path);
+    }
+
+    if (::listen(ListenFd, backlog) != 0) {
+        ThrowErrno(ListenFd, "can not listen " + Path);
+    }
+}
+
+void TUnixSocketServer::Serve(IExecuter& executer, const THandler& handler) {
+    try {
+        AcceptLoop(executer, handler);
+    } catch (...) {
+        ShutdownConnections();
+        throw;
+    }
+
+    ShutdownConnections();
+}
+
+void TUnixSocketServer::AcceptLoop(IExecuter& executer, const THandler& handler) {
+    while (!Stopped.load()) {
+        int fd = ::accept4(ListenFd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+
+            if (Stopped.load()) {
+                return;
+            }
+
+            throw std::system_error(errno, std::generic_category(), "can not accept on " + Path);
+        }
+
+        if (IdleTimeout.count() > 0) {
+            // a timed out read ends the input stream of the handler
+            timeval timeout{};
+            timeout.tv_sec = IdleTimeout.count() / 1000;
+            timeout.tv_usec = (IdleTimeout.count() % 1000) * 1000;
+            ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(ConnectionsMutex);
+            Connections.insert(fd);
+        }
+
+        executer.Add(TInlineTask([this, fd, &handler]() {
+            ServeConnection(fd, handler);
+        }));
+    }
+}
+
+void TUnixSocketServer::ServeConnection(int fd, const THandler& handler) {
+    {
+        TFdStreamBuf buffer(fd);
+        std::istream in(&buffer);
+        std::ostream out(&buffer);
+        try {
+            handler(in, out);
+        } catch (const std::exception& e) {
+            out << "error: " << e.what() << '\n';
+        }
+        out.flush();
+    }
+
+    // closed under the lock, so a reused descriptor is never shut down
+    std::lock_guard<std::mutex> lock(ConnectionsMutex);
+    Connections.erase(fd);
+    ::close(fd);
+}
+
+void TUnixSocketServer::ShutdownConnections() {
+    std::lock_guard<std::mutex> lock(ConnectionsMutex);
+    for (int fd : Connections) {
+        ::shutdown(fd, SHUT_RDWR);
+    }
+}
+
+void TUnixSocketServer::Stop() {
+    // only async signal safe calls, Serve() shuts down the connections
+    Stopped.store(true);
+    // wakes up accept
+    ::shutdown(ListenFd, SHUT_RDWR);
+}
+
+TUnixSocketServer::~TUnixSocketServer() {
+    ::close(ListenFd);
+    ::unlink(Path.c_str());
+}
+
+int ConnectUnixSocket(const std::string& path) {
+    auto address = MakeAddress(path);
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        ThrowErrno(-1, "can not create socket");
+    }
+
+    if (::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        ThrowErrno(fd, "can not connect to " + path);
+    }
+
+    return fd;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "executer/executer.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <istream>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_set>
+
+/*
+ * Server on a local Unix domain socket. Every accepted connection
+ * is served by a task on the executer, so the process and its caches
+ * live across requests. A connection idle for longer than the idle timeout
+ * is closed, so idle clients do not hold the workers. The socket file
+ * is replaced on start and removed on destruction.
+ */
+class TUnixSocketServer {
+public:
+    // serves one connection, exceptions are reported to the client as "error: <what>"
+    using THandler = std::function<void(std::istream& in, std::ostream& out)>;
+
+    // zero idle timeout waits for the client forever
+    explicit TUnixSocketServer(std::string path, int backlog = 64, std::chrono::milliseconds idleTimeout = std::chrono::milliseconds::zero());
+
+    TUnixSocketServer(const TUnixSocketServer&) = delete;
+
+    TUnixSocketServer& operator=(const TUnixSocketServer&) = delete;
+
+    // accepts connections until Stop(), then shuts down the open ones;
+    // the server and the handler must outlive the executer's tasks
+    void Serve(IExecuter& executer, const THandler& handler);
+
+    // may be called from any thread and from a signal handler
+    void Stop();
+
+    ~TUnixSocketServer();
+
+private:
+    void AcceptLoop(IExecuter& executer, const THandler& handler);
+
+    void ServeConnection(int fd, const THandler& handler);
+
+    // wakes up the reads of the open connections
+    void ShutdownConnections();
+
+    const std::string Path;
+    const std::chrono::milliseconds IdleTimeout;
+    int ListenFd;
+    std::atomic<bool> Stopped;
+    std::unordered_set<int> Connections;
+    std::mutex ConnectionsMutex;
+};
+
+// connects to the server, throws std::system_error on failure
+int ConnectUnixSocket(const std::string& path);
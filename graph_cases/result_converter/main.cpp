@@ -0,0 +1,67 @@
+#include "math_utils/combinatorics.h"
+#include "multipartite_graphs/multipartite_graphs.h"
+#include "multithread_writer/output_buffer.h"
+#include "optparser/optparser.h"
+#include "result_format/result_format.h"
+
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+
+/*
+ * Converts binary graph_cases results (--output-format binary or fixed)
+ * to the candidate lines of the text format.
+ */
+void Convert(std::istream& input, std::ostream& output) {
+    NResultFormat::TReader reader(input);
+    const auto& header = reader.Header();
+    NMultipartiteGraphs::TCompleteGraph source(header.Source.begin(), header.Source.end());
+    NMultipartiteGraphs::TCompleteGraph target(header.Target.begin(), header.Target.end());
+    auto allEdges = target.GenerateAllEdges();
+
+    constexpr size_t BlockSize = 64 * 1024;
+    TOutputBuffer buffer;
+    NResultFormat::TRecord record;
+    while (reader.Next(record)) {
+        NMultipartiteGraphs::TEdgeSet edges;
+        for (auto i : CombinationUnrank(allEdges.size(), header.DeletedEdges, record.Rank)) {
+            edges.insert(allEdges[i]);
+        }
+
+        NResultFormat::WriteText(buffer, header, source.ComponentsNumber(), edges, record.Verdict, record.Values.data(), record.Values.size());
+        if (buffer.Size() >= BlockSize) {
+            auto block = buffer.Take();
+            output.write(block.data(), block.size());
+        }
+    }
+
+    auto block = buffer.Take();
+    output.write(block.data(), block.size());
+}
+
+int main(int argc, const char ** argv) {
+    std::string inputFile = "";
+    std::string outputFile = "";
+
+    TParser optParser;
+    optParser.AddLongOption('i', "input-file").Store(&inputFile);
+    optParser.AddLongOption('o', "output-file").Store(&outputFile);
+    optParser.Parse(argc, argv);
+
+    std::unique_ptr<std::ifstream> inputFileStream{nullptr};
+    if (!inputFile.empty()) {
+        inputFileStream.reset(new std::ifstream(inputFile, std::ios::in | std::ios::binary));
+    }
+
+    std::unique_ptr<std::ofstream> outputFileStream{nullptr};
+    if (!outputFile.empty()) {
+        outputFileStream.reset(new std::ofstream(outputFile));
+    }
+
+    std::istream& inputStream = (inputFileStream.get() == nullptr) ? std::cin : *inputFileStream;
+    std::ostream& outputStream = (outputFileStream.get() == nullptr) ? std::cout : *outputFileStream;
+
+    Convert(inputStream, outputStream);
+    outputStream.flush();
+}
@@ -0,0 +1,98 @@
+#include "clock_cache/clock_cache.h"
+#include "clock_cache/inline_key.h"
+#include "test_system/test_system.h"
+
+#include <cstdint>
+#include <vector>
+
+UNIT_TEST_SUITE(ClockCache) {
+    UNIT_TEST(Unbounded) {
+        TClockCache<uint64_t, uint64_t> cache;
+        for (uint64_t i = 0; i != 10000; ++i) {
+            cache.Insert(i, i * i);
+        }
+
+        ASSERT_EQUAL(cache.Size(), 10000);
+        for (uint64_t i = 0; i != 10000; ++i) {
+            ASSERT_EQUAL(cache.Find(i).value_or(0), i * i);
+        }
+        ASSERT(!cache.Find(10000), "unexpected entry");
+
+        auto stats = cache.Stats();
+        ASSERT_EQUAL(stats.Hits, 10000);
+        ASSERT_EQUAL(stats.Misses, 1);
+        ASSERT_EQUAL(stats.Evictions, 0);
+    }
+
+    UNIT_TEST(Eviction) {
+        TClockCache<uint64_t, uint64_t> cache(100);
+        for (uint64_t i = 0; i != 100; ++i) {
+            cache.Insert(i, i);
+        }
+
+        // referenced entries survive the next sweep
+        for (uint64_t i = 0; i != 50; ++i) {
+            ASSERT(cache.Find(i), "entry " << i << " is missing");
+        }
+
+        for (uint64_t i = 100; i != 150; ++i) {
+            cache.Insert(i, i);
+        }
+
+        ASSERT_EQUAL(cache.Size(), 100);
+        ASSERT_EQUAL(cache.Stats().Evictions, 50);
+        for (uint64_t i = 0; i != 50; ++i) {
+            ASSERT(cache.Find(i), "referenced entry " << i << " is evicted");
+        }
+        for (uint64_t i = 100; i != 150; ++i) {
+            ASSERT_EQUAL(cache.Find(i).value_or(0), i);
+        }
+
+        size_t visited = 0;
+        cache.ForEach([&visited](uint64_t key, uint64_t value) {
+            ASSERT_EQUAL(key, value);
+            ++visited;
+        });
+        ASSERT_EQUAL(visited, 100);
+    }
+
+    UNIT_TEST(Budget) {
+        using TCache = TClockCache<uint64_t, uint64_t>;
+        ASSERT_EQUAL(TCache::CapacityForBudget(0), 0);
+        ASSERT(TCache::CapacityForBudget(1 << 20) > 1000, "budget is too pessimistic");
+
+        for (size_t budget : {size_t(1) << 20, size_t(1000003), size_t(100) << 10}) {
+            TCache cache(TCache::CapacityForBudget(budget));
+            ASSERT(cache.MemoryBytes() <= budget, "budget " << budget << " is exceeded: " << cache.MemoryBytes());
+            ASSERT(2 * cache.MemoryBytes() > budget, "budget " << budget << " is underused: " << cache.MemoryBytes());
+        }
+
+        TCache cache(TCache::CapacityForBudget(1));
+        cache.Insert(1, 1);
+        cache.Insert(2, 2);
+        ASSERT_EQUAL(cache.Size(), 1);
+        ASSERT_EQUAL(cache.Find(2).value_or(0), 2);
+    }
+
+    UNIT_TEST(InlineKey) {
+        using TKey = TInlineKey<uint16_t, 4>;
+        TKey first;
+        TKey second;
+        std::vector<unsigned> components = {3, 1, 2};
+        ASSERT(first.Assign(components.begin(), components.end()), "key should fit");
+        ASSERT(second.Assign(components.begin(), components.end()), "key should fit");
+        ASSERT(first == second, "equal keys differ");
+        ASSERT_EQUAL(first.Hash(), second.Hash());
+        ASSERT_EQUAL(first.Size(), 3);
+
+        std::vector<unsigned> longer = {1, 2, 3, 4, 5};
+        ASSERT(!second.Assign(longer.begin(), longer.end()), "too long key");
+        std::vector<unsigned> large = {70000};
+        ASSERT(!second.Assign(large.begin(), large.end()), "too large element");
+        ASSERT(first == second, "failed assignment should not change the key");
+
+        std::vector<unsigned> other = {3, 2, 1};
+        ASSERT(second.Assign(other.begin(), other.end()), "key should fit");
+        ASSERT(first != second, "order matters");
+    }
+}
@@ -134,4 +134,17 @@ UNIT_TEST_SUITE(ObjectCombinationGenerator) {
 
         ASSERT(expected == result, "");
     }
-}
\ No newline at end of file
+}
+
+UNIT_TEST_SUITE(CombinationRank) {
+    UNIT_TEST(MatchesGenerator) {
+        for (auto [n, k] : std::vector<std::pair<size_t, size_t>>{{7, 3}, {5, 5}, {6, 1}, {12, 4}}) {
+            uint64_t rank = 0;
+            for (const auto& combination : TChoiceGenerator(n, k)) {
+                ASSERT_EQUAL(CombinationRank(n, combination), rank);
+                AssertVectors(CombinationUnrank(n, k, rank), combination);
+                ++rank;
+            }
+        }
+    }
+}
@@ -1,8 +1,20 @@
 #include <test_system/test_system.h>
+#include "utils.h"
 
+#include <executer/chunked_task.h>
+#include <executer/cpu_topology.h>
 #include <executer/executer.h>
+#include <executer/histogram.h>
+#include <executer/parallel_reducer.h>
+#include <executer/work_stealing_deque.h>
 
+#include <array>
+#include <atomic>
 #include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
 
 UNIT_TEST_SUITE(Executer) {
     UNIT_TEST(FunctionTask) {
@@ -66,4 +78,515 @@ UNIT_TEST_SUITE(Executer) {
 
         ASSERT(found == 5, "wrong number of exceptions");
     }
-}
\ No newline at end of file
+
+    UNIT_TEST(WorkStealingFunctionTask) {
+        std::atomic<size_t> n = 0;
+
+        {
+            TExecuterOptions options;
+            options.ThreadCount = 8;
+            options.MaxQueueSize = 100;
+            options.WorkStealing = true;
+            auto executer = CreateExecuter(options);
+            for (size_t i = 0; i != 10000; ++i) {
+                executer->Add(CreateTask([&n]() {
+                    ++n;
+                }));
+            }
+        }
+
+        ASSERT_EQUAL(n.load(), 10000);
+    }
+
+    UNIT_TEST(WorkStealingNestedTasks) {
+        std::atomic<size_t> n = 0;
+
+        {
+            TExecuterOptions options;
+            options.ThreadCount = 4;
+            options.MaxQueueSize = 10;
+            options.WorkStealing = true;
+            auto executer = CreateExecuter(options);
+            IExecuter* raw = executer.get();
+            for (size_t i = 0; i != 100; ++i) {
+                executer->Add(CreateTask([&n, raw]() {
+                    // workers push to their own deques, past the queue limit
+                    for (size_t j = 0; j != 100; ++j) {
+                        raw->Add(CreateTask([&n]() {
+                            ++n;
+                        }));
+                    }
+                }));
+            }
+        }
+
+        ASSERT_EQUAL(n.load(), 10000);
+    }
+
+    UNIT_TEST(WorkStealingExceptions) {
+        TMultiThreadQueue<std::exception_ptr> exceptions(100);
+        {
+            TExecuterOptions options;
+            options.ThreadCount = 5;
+            options.Exceptions = &exceptions;
+            options.WorkStealing = true;
+            auto executer = CreateExecuter(options);
+            for (size_t i = 0; i != 10; ++i) {
+                executer->Add(std::make_unique<TSimpleTask>(i % 2 == 0));
+            }
+        }
+
+        ASSERT_EQUAL(exceptions.Size(), 5);
+    }
+
+    void CheckBatches(const TExecuterOptions& options) {
+        std::atomic<size_t> n = 0;
+        {
+            auto executer = CreateExecuter(options);
+            for (size_t batchIndex = 0; batchIndex != 100; ++batchIndex) {
+                std::vector<TInlineTask> batch;
+                for (size_t i = 0; i != 37; ++i) {
+                    batch.push_back(CreateTask([&n]() {
+                        ++n;
+                    }));
+                }
+                executer->AddBatch(std::move(batch));
+            }
+        }
+
+        ASSERT_EQUAL(n.load(), 3700);
+    }
+
+    UNIT_TEST(AddBatch) {
+        TExecuterOptions options;
+        options.MaxQueueSize = 10;
+        CheckBatches(options);
+
+        options.ThreadCount = 4;
+        CheckBatches(options);
+
+        options.PopBatchSize = 8;
+        CheckBatches(options);
+
+        options.LockFreeQueue = true;
+        CheckBatches(options);
+
+        options.WorkStealing = true;
+        CheckBatches(options);
+    }
+
+    UNIT_TEST(ChunkedSubmitter) {
+        std::atomic<size_t> sum = 0;
+        {
+            auto executer = CreateExecuter(4, 10, nullptr);
+            auto add = [&sum](size_t value) {
+                sum += value;
+            };
+            TChunkedSubmitter<size_t, decltype(add)> submitter(*executer, add, 16, 4);
+            for (size_t i = 1; i <= 1000; ++i) {
+                submitter.Add(size_t{i});
+            }
+        }
+
+        ASSERT_EQUAL(sum.load(), 500500);
+    }
+
+    void CheckReducer(const TExecuterOptions& options) {
+        auto executer = CreateExecuter(options);
+        TParallelReducer<size_t> reducer(*executer, 0);
+        ASSERT_EQUAL(reducer.SlotCount(), executer->ThreadCount() + 1);
+        for (size_t i = 1; i <= 10000; ++i) {
+            executer->Add(CreateTask([&reducer, i]() {
+                reducer.Local() += i;
+            }));
+        }
+
+        executer->Stop();
+        ASSERT_EQUAL(reducer.Reduce([](size_t& sum, size_t value) { sum += value; }), 50005000);
+    }
+
+    void CheckMetrics(TExecuterOptions options) {
+        std::stringstream report;
+        options.CollectMetrics = true;
+        options.MetricsReport = &report;
+        {
+            auto executer = CreateExecuter(options);
+            for (size_t i = 0; i != 1000; ++i) {
+                executer->Add(CreateTask([]() {}));
+            }
+
+            executer->Stop();
+            ASSERT(executer->Metrics() != nullptr, "metrics should be collected");
+            ASSERT_EQUAL(executer->Metrics()->Execution().Count(), 1000);
+            ASSERT_EQUAL(executer->Metrics()->QueueWait().Count(), 1000);
+            ASSERT_EQUAL(executer->Metrics()->AddTime().Count(), options.ThreadCount <= 1 ? 0 : 1000);
+        }
+
+        auto text = report.str();
+        ASSERT(text.find("queue wait (us): count 1000") != std::string::npos, text);
+        ASSERT_EQUAL_WITH_MESSAGE(text.find("worker 0:") != std::string::npos, options.ThreadCount > 1, text);
+        ASSERT_EQUAL_WITH_MESSAGE(text.find("queue wait"), text.rfind("queue wait"), "metrics should be reported once");
+    }
+
+    UNIT_TEST(Metrics) {
+        TExecuterOptions options;
+        CheckMetrics(options);
+
+        options.ThreadCount = 3;
+        CheckMetrics(options);
+
+        options.WorkStealing = true;
+        CheckMetrics(options);
+
+        auto executer = CreateExecuter(TExecuterOptions());
+        ASSERT(executer->Metrics() == nullptr, "metrics are off by default");
+    }
+
+    void CheckCancel(const TExecuterOptions& options) {
+        std::atomic<size_t> started = 0;
+        std::atomic<bool> release = false;
+        std::atomic<size_t> n = 0;
+        auto executer = CreateExecuter(options);
+        for (size_t i = 0; i != options.ThreadCount; ++i) {
+            executer->Add(CreateTask([&started, &release]() {
+                ++started;
+                while (!release.load()) {
+                    std::this_thread::yield();
+                }
+            }));
+        }
+
+        while (started.load() != options.ThreadCount) {
+            std::this_thread::yield();
+        }
+
+        for (size_t i = 0; i != 100; ++i) {
+            executer->Add(CreateTask([&n]() {
+                ++n;
+            }));
+        }
+
+        ASSERT(!executer->IsCancelled(), "executer is not cancelled yet");
+        executer->Cancel();
+        ASSERT(executer->IsCancelled(), "executer should be cancelled");
+        ASSERT(!executer->CancellationToken()->Cancel(), "second cancel should be a no-op");
+        executer->Add(CreateTask([&n]() {
+            ++n;
+        }));
+
+        release.store(true);
+        executer->Stop();
+        ASSERT_EQUAL(n.load(), 0);
+    }
+
+    UNIT_TEST(Cancel) {
+        TExecuterOptions options;
+        options.ThreadCount = 2;
+        CheckCancel(options);
+
+        options.LockFreeQueue = true;
+        CheckCancel(options);
+
+        options.WorkStealing = true;
+        CheckCancel(options);
+
+        size_t n = 0;
+        auto executer = CreateExecuter(TExecuterOptions());
+        for (size_t i = 0; i != 10; ++i) {
+            executer->Add(CreateTask([&n, &executer]() {
+                if (++n == 3) {
+                    executer->Cancel();
+                }
+            }));
+        }
+
+        ASSERT_EQUAL(n, 3);
+    }
+
+    UNIT_TEST(ParallelReducer) {
+        TExecuterOptions options;
+        CheckReducer(options);
+
+        options.ThreadCount = 4;
+        CheckReducer(options);
+
+        options.LockFreeQueue = true;
+        CheckReducer(options);
+
+        options.WorkStealing = true;
+        CheckReducer(options);
+    }
+
+    UNIT_TEST(ParallelReducerOtherExecuter) {
+        TExecuterOptions options;
+        options.ThreadCount = 2;
+        auto owner = CreateExecuter(options);
+        auto other = CreateExecuter(options);
+        TParallelReducer<size_t> reducer(*owner, 0);
+
+        // worker 0 of another executer must not share the slot of worker 0 of the owner
+        other->Add(CreateTask([&reducer]() {
+            reducer.Local() += 5;
+        }));
+        other->Stop();
+        owner->Add(CreateTask([&reducer]() {
+            reducer.Local() += 1;
+        }));
+        owner->Stop();
+
+        std::vector<size_t> slots;
+        reducer.ForEachLocal([&slots](size_t value) {
+            slots.push_back(value);
+        });
+        ASSERT_EQUAL(slots, std::vector<size_t>({1, 5}));
+
+        try {
+            reducer.Local() += 1;
+        } catch (const std::logic_error&) {
+            return;
+        }
+
+        FAIL("the shared slot should not be used by a second thread");
+    }
+}
+
+UNIT_TEST_SUITE(WorkStealingDeque) {
+    UNIT_TEST(FifoSteal) {
+        TWorkStealingDeque<size_t> deque(2);
+        for (size_t i = 0; i != 100; ++i) {
+            deque.Push(i);
+        }
+
+        ASSERT_EQUAL(deque.Size(), 100);
+        for (size_t i = 0; i != 100; ++i) {
+            size_t value = 0;
+            ASSERT(deque.Steal(value), "steal failed at " << i);
+            ASSERT_EQUAL(value, i);
+        }
+
+        size_t value = 0;
+        ASSERT(!deque.Steal(value), "deque should be empty");
+    }
+
+    UNIT_TEST(ConcurrentSteal) {
+        constexpr size_t itemCount = 100000;
+        TWorkStealingDeque<size_t> deque(4);
+        std::atomic<bool> done = false;
+        std::vector<std::atomic<size_t>> seen(itemCount);
+        std::vector<std::thread> thieves;
+        for (size_t i = 0; i != 4; ++i) {
+            thieves.emplace_back([&deque, &done, &seen]() {
+                size_t value = 0;
+                while (!done.load() || deque.Size() != 0) {
+                    if (deque.Steal(value)) {
+                        ++seen[value];
+                    }
+                }
+            });
+        }
+
+        for (size_t i = 0; i != itemCount; ++i) {
+            deque.Push(i);
+        }
+
+        done = true;
+        for (auto& thief : thieves) {
+            thief.join();
+        }
+
+        for (size_t i = 0; i != itemCount; ++i) {
+            ASSERT_EQUAL_WITH_MESSAGE(seen[i].load(), 1, "item " << i);
+        }
+    }
+
+    UNIT_TEST(LifoPop) {
+        TWorkStealingDeque<size_t> deque(2);
+        for (size_t i = 0; i != 10; ++i) {
+            deque.Push(i);
+        }
+
+        size_t value = 0;
+        ASSERT(deque.Steal(value), "steal failed");
+        ASSERT_EQUAL(value, 0);
+        for (size_t i = 9; i != 0; --i) {
+            ASSERT(deque.Pop(value), "pop failed at " << i);
+            ASSERT_EQUAL(value, i);
+        }
+
+        ASSERT(!deque.Pop(value), "deque should be empty");
+        ASSERT(!deque.Steal(value), "deque should be empty");
+    }
+
+    UNIT_TEST(ConcurrentPopAndSteal) {
+        constexpr size_t itemCount = 100000;
+        TWorkStealingDeque<size_t> deque(4);
+        std::atomic<bool> done = false;
+        std::vector<std::atomic<size_t>> seen(itemCount);
+        std::vector<std::thread> thieves;
+        for (size_t i = 0; i != 3; ++i) {
+            thieves.emplace_back([&deque, &done, &seen]() {
+                size_t value = 0;
+                while (!done.load() || deque.Size() != 0) {
+                    if (deque.Steal(value)) {
+                        ++seen[value];
+                    }
+                }
+            });
+        }
+
+        size_t value = 0;
+        for (size_t i = 0; i != itemCount; ++i) {
+            deque.Push(i);
+            if (i % 3 == 0 && deque.Pop(value)) {
+                ++seen[value];
+            }
+        }
+
+        while (deque.Pop(value)) {
+            ++seen[value];
+        }
+
+        done = true;
+        for (auto& thief : thieves) {
+            thief.join();
+        }
+
+        for (size_t i = 0; i != itemCount; ++i) {
+            ASSERT_EQUAL_WITH_MESSAGE(seen[i].load(), 1, "item " << i);
+        }
+    }
+}
+
+UNIT_TEST_SUITE(InlineTask) {
+    UNIT_TEST(SmallIsInline) {
+        size_t n = 0;
+        TInlineTask task([&n]() {
+            ++n;
+        });
+
+        ASSERT(task.IsInline(), "small closure should be stored inline");
+        task();
+        task();
+        ASSERT_EQUAL(n, 2);
+    }
+
+    UNIT_TEST(BigIsOnHeap) {
+        std::array<size_t, 16> values{};
+        values[15] = 5;
+        size_t n = 0;
+        TInlineTask task([values, &n]() {
+            n += values[15];
+        });
+
+        ASSERT(!task.IsInline(), "big closure should be stored on heap");
+        task();
+        ASSERT_EQUAL(n, 5);
+    }
+
+    UNIT_TEST(MoveOnlyCapture) {
+        auto counter = std::make_shared<size_t>(0);
+        TInlineTask task([counter, value = std::make_unique<size_t>(3)]() {
+            *counter += *value;
+        });
+
+        TInlineTask moved(std::move(task));
+        ASSERT(!task, "moved-from task should be empty");
+        moved();
+
+        TInlineTask assigned;
+        assigned = std::move(moved);
+        assigned();
+        ASSERT_EQUAL(*counter, 6);
+
+        assigned = TInlineTask();
+        ASSERT_EQUAL(counter.use_count(), 1);
+    }
+}
+
+UNIT_TEST_SUITE(CpuTopology) {
+    // two packages with two cores each, every core has two hyperthreads
+    std::vector<TCpu> MakeCpus() {
+        std::vector<TCpu> cpus;
+        for (size_t id = 0; id != 8; ++id) {
+            TCpu cpu;
+            cpu.Id = id;
+            cpu.Package = (id / 2) % 2;
+            cpu.Core = id / 4;
+            cpus.push_back(cpu);
+        }
+
+        return cpus;
+    }
+
+    std::vector<size_t> Ids(const std::vector<TCpu>& layout) {
+        std::vector<size_t> result;
+        for (const auto& cpu : layout) {
+            result.push_back(cpu.Id);
+        }
+
+        return result;
+    }
+
+    UNIT_TEST(Compact) {
+        auto layout = PlanWorkerCpus(MakeCpus(), 10, EPinPolicy::Compact);
+        AssertVectors(Ids(layout), std::vector<size_t>{0, 4, 1, 5, 2, 6, 3, 7, 0, 4});
+    }
+
+    UNIT_TEST(Spread) {
+        auto layout = PlanWorkerCpus(MakeCpus(), 4, EPinPolicy::Spread);
+        AssertVectors(Ids(layout), std::vector<size_t>{0, 2, 4, 6});
+    }
+
+    UNIT_TEST(None) {
+        ASSERT(PlanWorkerCpus(MakeCpus(), 4, EPinPolicy::None).empty(), "workers should not be pinned");
+        ASSERT(PlanWorkerCpus({}, 4, EPinPolicy::Compact).empty(), "no cpus to pin to");
+    }
+
+    UNIT_TEST(PinnedExecuter) {
+        std::atomic<size_t> n = 0;
+        {
+            TExecuterOptions options;
+            options.ThreadCount = 3;
+            options.Pinning = EPinPolicy::Spread;
+            auto executer = CreateExecuter(options);
+            for (size_t i = 0; i != 1000; ++i) {
+                executer->Add(CreateTask([&n]() {
+                    ++n;
+                }));
+            }
+        }
+
+        ASSERT_EQUAL(n.load(), 1000);
+    }
+}
+
+UNIT_TEST_SUITE(LogLinearHistogram) {
+    UNIT_TEST(Buckets) {
+        for (uint64_t value = 0; value != 100000; ++value) {
+            size_t index = TLogLinearHistogram::BucketIndex(value);
+            ASSERT(value <= TLogLinearHistogram::BucketUpperBound(index), "value " << value << " above its bucket");
+            ASSERT(index == 0 || value > TLogLinearHistogram::BucketUpperBound(index - 1), "value " << value << " below its bucket");
+        }
+
+        size_t last = TLogLinearHistogram::BucketIndex(~uint64_t{0});
+        ASSERT_EQUAL(last, TLogLinearHistogram::BucketCount - 1);
+        ASSERT_EQUAL(TLogLinearHistogram::BucketUpperBound(last), ~uint64_t{0});
+    }
+
+    UNIT_TEST(Quantiles) {
+        TLogLinearHistogram histogram;
+        for (uint64_t value = 1; value <= 1000; ++value) {
+            histogram.Record(value);
+        }
+
+        ASSERT_EQUAL(histogram.Count(), 1000);
+        ASSERT_EQUAL(histogram.Sum(), 500500);
+        ASSERT_EQUAL(histogram.Max(), 1000);
+
+        uint64_t median = histogram.Quantile(0.5);
+        ASSERT(median >= 500 && median <= 500 * 9 / 8, "median " << median);
+        uint64_t p99 = histogram.Quantile(0.99);
+        ASSERT(p99 >= 990 && p99 <= 990 * 9 / 8, "p99 " << p99);
+        ASSERT_EQUAL(TLogLinearHistogram().Quantile(0.5), 0);
+    }
+}
@@ -2,8 +2,21 @@
 
 #include "test_system/test_system.h"
 
+#include "executer/executer.h"
+#include "multipartite_graphs/acyclic_count_table.h"
+#include "multipartite_graphs/acyclic_orintations.h"
+#include "multipartite_graphs/complete_graph_tables.h"
 #include "multipartite_graphs/multipartite_graphs.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <random>
+#include <stdexcept>
+#include <unordered_set>
+
 UNIT_TEST(BetweenParts) {
    using namespace NMultipartiteGraphs;
    TCompleteGraph graph({3, 2});
@@ -59,6 +72,16 @@ UNIT_TEST_SUITE(TestAllEdges) {
 }
 
 UNIT_TEST_SUITE(Invariants) {
+    UNIT_TEST(TestPtLargeAndEmptyParts) {
+        using namespace NMultipartiteGraphs;
+
+        ASSERT_EQUAL(TCompleteGraph({3, 0}).PtInvariant(), TCompleteGraph({3}).PtInvariant());
+        ASSERT_EQUAL(TCompleteGraph({0}).PtInvariant(), 0);
+        // 2^69 vanishes modulo the width of INT, only the -1 is left
+        ASSERT_EQUAL(TCompleteGraph({70, 2}).PtInvariant(), TCompleteGraph({2}).PtInvariant() - 1);
+        ASSERT_EQUAL(TCompleteGraph({32}).PtInvariant(), (INT(1) << 31) - 1);
+    }
+
     UNIT_TEST(TestOneEdge) {
         using namespace NMultipartiteGraphs;
 
@@ -245,6 +268,47 @@ UNIT_TEST_SUITE(TestSwapVertices) {
     }
 }
 
+UNIT_TEST_SUITE(TestDeleteEdge) {
+    UNIT_TEST(IncrementalInvariants) {
+        using namespace NMultipartiteGraphs;
+
+        std::mt19937 generator(42);
+        for (const auto& components : std::vector<std::vector<INT>>{{3, 3}, {3, 2, 2}, {2, 2, 2, 2}, {4, 3, 1}}) {
+            TCompleteGraph completeGraph(components);
+            for (size_t attempt = 0; attempt != 10; ++attempt) {
+                auto allEdges = completeGraph.GenerateAllEdges();
+                std::shuffle(allEdges.begin(), allEdges.end(), generator);
+
+                TDenseGraph graph(completeGraph, {});
+                graph.I4Invariant();
+                graph.PtInvariant();
+                for (size_t i = 0; i != 7; ++i) {
+                    graph = graph.DeleteEdge(allEdges[i]);
+                    TDenseGraph fresh(completeGraph, graph.DeletedEdges());
+                    ASSERT_EQUAL(graph.I4Invariant(), fresh.I4Invariant());
+                    ASSERT_EQUAL(graph.PtInvariant(), fresh.PtInvariant());
+                    ASSERT_EQUAL(graph.I3Invariant(), fresh.I3Invariant());
+                }
+            }
+        }
+    }
+
+    UNIT_TEST(DeletedTwice) {
+        using namespace NMultipartiteGraphs;
+
+        TCompleteGraph completeGraph({2, 2});
+        TEdge edge(TVertex(0, 0), TVertex(1, 1));
+        TDenseGraph graph(completeGraph, {edge});
+        try {
+            graph.DeleteEdgeInplace(TEdge(TVertex(1, 1), TVertex(0, 0)));
+        } catch (const std::logic_error&) {
+            return;
+        }
+
+        FAIL("deleting an edge twice should throw");
+    }
+}
+
 UNIT_TEST_SUITE(TestContractEdge) {
     UNIT_TEST(Simple) {
         using namespace NMultipartiteGraphs;
@@ -502,4 +566,194 @@ UNIT_TEST_SUITE(TestDenseGraph) {
         ASSERT_EQUAL(newDenseGraph.DeletedEdges(), edgeSet);
         ASSERT_EQUAL(newDenseGraph.BaseGraph(), &graph);
     }
-}
\ No newline at end of file
+}
+UNIT_TEST_SUITE(TestCompleteGraphSignature) {
+    UNIT_TEST(Invariants) {
+        using namespace NMultipartiteGraphs;
+        TCompleteGraph graph({4, 4, 3});
+        const auto& signature = graph.Signature();
+        ASSERT_EQUAL(signature.VerticesCount(), 11);
+        ASSERT_EQUAL(signature.I2Invariant(), 40);
+        ASSERT_EQUAL(signature.I3Invariant(), 48);
+        ASSERT_EQUAL(signature.I4Invariant(), 72);
+        ASSERT_EQUAL(signature.PtInvariant(), 17);
+    }
+
+    UNIT_TEST(ZeroInvariants) {
+        using namespace NMultipartiteGraphs;
+        TCompleteGraph graph({1, 1});
+        ASSERT_EQUAL(graph.I3Invariant(), 0);
+        ASSERT_EQUAL(graph.I4Invariant(), 0);
+        ASSERT_EQUAL(graph.PtInvariant(), 0);
+
+        TCompleteGraph empty;
+        ASSERT_EQUAL(empty.VerticesCount(), 0);
+        ASSERT_EQUAL(empty.I4Invariant(), 0);
+    }
+
+    UNIT_TEST(SharedBetweenCopies) {
+        using namespace NMultipartiteGraphs;
+        TCompleteGraph graph({3, 3, 2});
+        TCompleteGraph copy = graph;
+        ASSERT_EQUAL(&graph.Signature(), &copy.Signature());
+    }
+
+    UNIT_TEST(ConcurrentAcyclicOrientations) {
+        using namespace NMultipartiteGraphs;
+        TCompleteGraph graph({4, 3, 3});
+        std::atomic<size_t> mismatches = 0;
+        {
+            auto executer = CreateExecuter(8, 100, nullptr);
+            for (size_t i = 0; i != 1000; ++i) {
+                executer->Add(CreateTask([&graph, &mismatches]() {
+                    if (graph.CountAcyclicOrientations() != TCompleteGraph({3, 4, 3}).CountAcyclicOrientations()) {
+                        ++mismatches;
+                    }
+                }));
+            }
+        }
+
+        ASSERT_EQUAL(mismatches.load(), 0);
+    }
+}
+
+UNIT_TEST_SUITE(TestAcyclicCountTable) {
+    UNIT_TEST(Merge) {
+        using namespace NMultipartiteGraphs;
+        const std::string path = "test_acyclic_count_table.bin";
+        std::remove(path.c_str());
+
+        ASSERT_EQUAL(TAcyclicCountTable(path).Size(), 0);
+
+        TAcyclicCountTable::Merge(path, {{{3, 4}, 1066}, {{2, 2, 7}, 1682766}});
+        std::vector<std::pair<std::vector<INT>, long long>> entries;
+        for (INT i = 1; i != 100; ++i) {
+            entries.push_back({{i, i + 1}, static_cast<long long>(i)});
+        }
+        // too many components are not stored
+        entries.push_back({std::vector<INT>(TAcyclicCountTable::MaxComponents + 1, 1), 1});
+        TAcyclicCountTable::Merge(path, entries);
+
+        // entries already in the file are kept
+        TAcyclicCountTable table(path);
+        ASSERT_EQUAL(table.Size(), 100);
+        ASSERT_EQUAL(table.Find({3, 4}).value_or(0), 1066);
+        ASSERT_EQUAL(table.Find({2, 2, 7}).value_or(0), 1682766);
+        ASSERT_EQUAL(table.Find({50, 51}).value_or(0), 50);
+        ASSERT(!table.Find({4, 4}), "unexpected entry");
+        ASSERT_EQUAL(table.Entries().size(), 100);
+
+        std::remove(path.c_str());
+        std::remove((path + ".lock").c_str());
+    }
+
+    UNIT_TEST(CorruptedHeader) {
+        using namespace NMultipartiteGraphs;
+        const std::string path = "test_acyclic_count_table_corrupted.bin";
+        std::remove(path.c_str());
+        TAcyclicCountTable::Merge(path, {{{3, 4}, 1066}});
+
+        // capacity and count follow the magic and the version
+        auto corrupt = [&](size_t offset, uint64_t value) {
+            std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+            file.seekp(offset);
+            file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+        };
+
+        uint64_t capacity = 0;
+        {
+            std::ifstream file(path, std::ios::binary);
+            file.seekg(8);
+            file.read(reinterpret_cast<char*>(&capacity), sizeof(capacity));
+        }
+
+        corrupt(16, capacity);
+        try {
+            TAcyclicCountTable table(path);
+            FAIL("a table without empty slots should be rejected");
+        } catch (const std::runtime_error&) {
+        }
+
+        corrupt(16, 1);
+        corrupt(8, capacity - 1);
+        try {
+            TAcyclicCountTable table(path);
+            FAIL("a capacity which is not a power of two should be rejected");
+        } catch (const std::runtime_error&) {
+        }
+
+        std::remove(path.c_str());
+        std::remove((path + ".lock").c_str());
+    }
+
+    UNIT_TEST(Counter) {
+        using namespace NMultipartiteGraphs;
+        const std::string path = "test_acyclic_counter.bin";
+        std::remove(path.c_str());
+        {
+            TCompleteGraphAcyclicOrientationsCounter counter;
+            counter.AttachTable(path);
+            ASSERT_EQUAL(counter({2, 7, 2}), 1682766);
+            counter.SaveTable();
+        }
+
+        TAcyclicCountTable table(path);
+        ASSERT_EQUAL(table.Find({2, 2, 7}).value_or(0), 1682766);
+        ASSERT(table.Size() > 1, "subproblems should be saved too");
+
+        TCompleteGraphAcyclicOrientationsCounter counter;
+        counter.AttachTable(path);
+        ASSERT_EQUAL(counter({7, 2, 2}), 1682766);
+        ASSERT_EQUAL(counter({3, 4}), 1066);
+
+        std::remove(path.c_str());
+        std::remove((path + ".lock").c_str());
+    }
+}
+
+UNIT_TEST_SUITE(TestCompleteGraphTables) {
+    UNIT_TEST(PartitionIndex) {
+        using namespace NMultipartiteGraphs;
+        std::unordered_set<size_t> indices;
+        std::vector<INT> current;
+        std::function<void(INT, INT)> generate = [&](INT remaining, INT bound) {
+            if (remaining == 0) {
+                auto index = PartitionIndex(current);
+                ASSERT(index < CompleteGraphTableSize, "index " << index << " is out of the table");
+                ASSERT(indices.insert(index).second, "index " << index << " is repeated");
+                return;
+            }
+
+            for (INT part = std::min(remaining, bound); part > 0; --part) {
+                current.push_back(part);
+                generate(remaining - part, part);
+                current.pop_back();
+            }
+        };
+
+        for (INT vertices = 0; vertices <= CompleteGraphTableMaxVertices; ++vertices) {
+            generate(vertices, vertices);
+        }
+
+        ASSERT_EQUAL(indices.size(), CompleteGraphTableSize);
+        ASSERT_EQUAL(CompleteGraphTableSize, 2714);
+    }
+
+    UNIT_TEST(Entries) {
+        using namespace NMultipartiteGraphs;
+        auto entry = FindCompleteGraphTableEntry({2, 7, 2});
+        ASSERT(entry != nullptr, "small graph should be in the table");
+        ASSERT_EQUAL(entry->AcyclicOrientations, 1682766);
+        ASSERT_EQUAL(entry->Sigmas[1], 11);
+        ASSERT_EQUAL(entry->Sigmas[2], 4 + 14 + 14);
+        ASSERT_EQUAL(entry->Sigmas[3], 28);
+        ASSERT_EQUAL(entry->I4, 1 + 21 + 21);
+        ASSERT_EQUAL(entry->Pt, 2 + 64 + 2 - 3);
+
+        // 20! orientations of the complete graph do not fit into INT
+        ASSERT_EQUAL(FindCompleteGraphTableEntry(std::vector<INT>(20, 1))->AcyclicOrientations, 2432902008176640000ll);
+
+        ASSERT(FindCompleteGraphTableEntry({11, 10}) == nullptr, "large graph should not be in the table");
+        ASSERT(FindCompleteGraphTableEntry({3, 0}) == nullptr, "empty parts are not in the table");
+    }
+}
@@ -38,4 +38,27 @@ UNIT_TEST_SUITE(OptParse) {
         ASSERT(s == "source", "s should be equal to source");
         ASSERT(i == 2, "i should be equal to 2");
     }
-}
\ No newline at end of file
+
+    UNIT_TEST(Double) {
+        double budget;
+        double ratio;
+
+        TParser parser;
+        parser.AddLongOption("budget").Store(&budget);
+        parser.AddLongOption("ratio").Store(&ratio).Default("0.25");
+
+        std::vector<std::string> args = {
+            "program", "--budget", "1.5"
+        };
+
+        std::vector<const char*> argv;
+        for (const auto& arg : args) {
+            argv.push_back(arg.data());
+        }
+
+        parser.Parse(3, argv.data());
+
+        ASSERT(budget == 1.5, "budget should be equal to 1.5");
+        ASSERT(ratio == 0.25, "ratio should be equal to the default");
+    }
+}
@@ -0,0 +1,110 @@
+#include "mapped_file/mapped_file.h"
+#include "query_format/query_format.h"
+#include "test_system/test_system.h"
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+
+UNIT_TEST_SUITE(QueryFormat) {
+    using NMultipartiteGraphs::TEdge;
+    using NMultipartiteGraphs::TVertex;
+
+    void CheckQuery(const NQueryFormat::TQuery& query, const std::vector<INT>& components, const std::vector<TEdge>& edges) {
+        ASSERT_EQUAL(query.Components.size(), components.size());
+        for (size_t i = 0; i != components.size(); ++i) {
+            ASSERT_EQUAL(query.Components[i], components[i]);
+        }
+
+        ASSERT_EQUAL(query.Edges.size(), edges.size());
+        for (size_t i = 0; i != edges.size(); ++i) {
+            ASSERT(query.Edges[i] == edges[i], "edge " << i << " differs");
+        }
+    }
+
+    UNIT_TEST(Text) {
+        std::string text = "3 3 2\r\n2\n\n0 0 1 1\n1 2\t 3\n  2 1 0 2  \n4 1\n0\nexit\n1 1\n0\n";
+        NQueryFormat::TQueryReader reader(text);
+        ASSERT(!reader.IsBinary(), "text is detected as binary");
+
+        NQueryFormat::TQuery query;
+        ASSERT(reader.Next(query), "first query is missing");
+        CheckQuery(query, {3, 3, 2}, {TEdge(TVertex(0, 0), TVertex(1, 1)), TEdge(TVertex(2, 1), TVertex(0, 2))});
+        ASSERT(reader.Next(query), "second query is missing");
+        CheckQuery(query, {4, 1}, {});
+        ASSERT(!reader.Next(query), "queries after exit should be ignored");
+    }
+
+    UNIT_TEST(BadToken) {
+        NQueryFormat::TQueryReader reader("3 x\n0\n");
+        NQueryFormat::TQuery query;
+        try {
+            reader.Next(query);
+            FAIL("bad token should throw");
+        } catch (const std::runtime_error&) {
+        }
+    }
+
+    UNIT_TEST(Binary) {
+        std::vector<NQueryFormat::TQuery> queries(2);
+        queries[0].Components = {300, 2};
+        queries[0].Edges = {TEdge(TVertex(0, 299), TVertex(1, 1))};
+        queries[1].Components = {1, 1, 1};
+
+        TOutputBuffer buffer;
+        NQueryFormat::WriteHeader(buffer);
+        for (const auto& query : queries) {
+            NQueryFormat::WriteQuery(buffer, query);
+        }
+
+        const std::string path = "test_query_format.bin";
+        {
+            std::ofstream out(path, std::ios::binary);
+            out << buffer.Str();
+        }
+
+        TMappedFile file(path);
+        std::remove(path.c_str());
+        ASSERT_EQUAL(file.Size(), buffer.Size());
+
+        NQueryFormat::TQueryReader reader(file.View());
+        ASSERT(reader.IsBinary(), "binary is not detected");
+        NQueryFormat::TQuery query;
+        for (const auto& expected : queries) {
+            ASSERT(reader.Next(query), "query is missing");
+            CheckQuery(query, expected.Components, expected.Edges);
+        }
+        ASSERT(!reader.Next(query), "unexpected query");
+
+        auto truncated = buffer.Str();
+        truncated.pop_back();
+        NQueryFormat::TQueryReader truncatedReader(truncated);
+        ASSERT(truncatedReader.Next(query), "first query is complete");
+        try {
+            truncatedReader.Next(query);
+            FAIL("truncated query should throw");
+        } catch (const std::runtime_error&) {
+        }
+    }
+
+    UNIT_TEST(MapOnlyRegularFiles) {
+        const std::string path = "test_query_format.fifo";
+        std::remove(path.c_str());
+        ASSERT_EQUAL(::mkfifo(path.c_str(), 0600), 0);
+        ASSERT(!TMappedFile::CanMap(path), "a fifo can not be mapped");
+        ASSERT(!TMappedFile::CanMap(path + ".missing"), "a missing file can not be mapped");
+        std::remove(path.c_str());
+
+        const std::string regular = "test_query_format.txt";
+        {
+            std::ofstream out(regular);
+            out << "1 1\n1\n0 1\n";
+        }
+        ASSERT(TMappedFile::CanMap(regular), "a regular file is mapped");
+        std::remove(regular.c_str());
+    }
+}
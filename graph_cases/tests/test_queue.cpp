@@ -1,6 +1,8 @@
 #include "test_system/test_system.h"
 
+#include "queue/lock_free_queue.h"
 #include "queue/queue.h"
+#include "queue/ring_buffer.h"
 
 #include <atomic>
 #include <string>
@@ -51,8 +53,8 @@ struct hash<TSimpleStruct> {
 
 
 UNIT_TEST_SUITE(Queue) {
-    template<typename T>
-    void thread_func(std::unordered_set<T>& set, std::atomic<bool>& alive, TMultiThreadQueue<T>& queue, std::mutex& m) {
+    template<typename T, typename TQueue>
+    void thread_func(std::unordered_set<T>& set, std::atomic<bool>& alive, TQueue& queue, std::mutex& m) {
         while (alive) {
             T result;
             if (queue.Pop(std::chrono::seconds(1), result)) {
@@ -64,9 +66,9 @@ UNIT_TEST_SUITE(Queue) {
         }
     }
 
-    template<typename T>
+    template<typename T, template<typename> class TQueue = TMultiThreadQueue>
     struct TQueueTester {
-        TMultiThreadQueue<T> Queue;
+        TQueue<T> Queue;
         std::atomic<bool> Alive;
         std::mutex Mutex;
         std::unordered_set<T> Result;
@@ -77,7 +79,7 @@ UNIT_TEST_SUITE(Queue) {
             , Alive(true)
         {
             for (int i = 0; i != threadCount; ++i) {
-                Workers.emplace_back(thread_func<T>, std::ref(Result), std::ref(Alive), std::ref(Queue), std::ref(Mutex));
+                Workers.emplace_back(thread_func<T, TQueue<T>>, std::ref(Result), std::ref(Alive), std::ref(Queue), std::ref(Mutex));
             }
 
             for (int i = 0; i != rightBorder; ++i) {
@@ -112,4 +114,97 @@ UNIT_TEST_SUITE(Queue) {
     UNIT_TEST(SimpleStruct) {
         TQueueTester<TSimpleStruct> tester(6, 10000, 1000);
     }
+
+    UNIT_TEST(LockFree) {
+        TQueueTester<int, TLockFreeQueue> tester(6, 10000, 1000);
+    }
+
+    UNIT_TEST(LockFreeStruct) {
+        TQueueTester<TSimpleStruct, TLockFreeQueue> tester(6, 10000, 16);
+    }
+
+    UNIT_TEST(LockFreeBounded) {
+        TLockFreeQueue<int> queue(3);
+        ASSERT_EQUAL(queue.Capacity(), 4);
+        for (int i = 0; i != 4; ++i) {
+            ASSERT(queue.TryPush(int{i}), "push failed at " << i);
+        }
+
+        ASSERT(!queue.TryPush(4), "queue should be full");
+        ASSERT_EQUAL(queue.Size(), 4);
+
+        int value = 0;
+        ASSERT(queue.Pop(std::chrono::seconds(1), value), "pop failed");
+        ASSERT_EQUAL(value, 0);
+        ASSERT(queue.TryPush(4), "queue should have space");
+
+        for (int i = 1; i != 5; ++i) {
+            ASSERT_EQUAL(queue.Pop(), i);
+        }
+
+        ASSERT(queue.IsEmpty(), "queue should be empty");
+        ASSERT(!queue.Pop(std::chrono::seconds(0), value), "pop from empty queue should time out");
+    }
+
+    UNIT_TEST(PushManyPopMany) {
+        TMultiThreadQueue<int> queue(10);
+        std::vector<int> popped;
+        std::thread consumer([&queue, &popped]() {
+            std::vector<int> items;
+            while (popped.size() != 100) {
+                items.clear();
+                queue.PopMany(items, 7);
+                ASSERT(items.size() <= 7, "too many items popped");
+                popped.insert(popped.end(), items.begin(), items.end());
+            }
+        });
+
+        std::vector<int> items;
+        for (int i = 0; i != 100; ++i) {
+            items.push_back(i);
+        }
+
+        queue.PushMany(std::move(items));
+        consumer.join();
+
+        ASSERT(items.empty(), "items should be moved out");
+        for (int i = 0; i != 100; ++i) {
+            ASSERT_EQUAL_WITH_MESSAGE(popped[i], i, "at " << i);
+        }
+    }
+}
+
+UNIT_TEST_SUITE(RingBuffer) {
+    UNIT_TEST(Wraparound) {
+        TRingBuffer<int> buffer(4);
+        int next = 0;
+        for (int i = 0; i != 100; ++i) {
+            buffer.PushBack(int{i});
+            if (buffer.Size() == 3) {
+                ASSERT_EQUAL(buffer.Front(), next);
+                buffer.PopFront();
+                ++next;
+            }
+        }
+
+        ASSERT_EQUAL(buffer.Capacity(), 4);
+        ASSERT_EQUAL(buffer.Size(), 2);
+    }
+
+    UNIT_TEST(Grow) {
+        TRingBuffer<std::string> buffer;
+        buffer.PushBack("x");
+        buffer.PopFront();
+        for (int i = 0; i != 100; ++i) {
+            buffer.PushBack(std::to_string(i));
+        }
+
+        ASSERT_EQUAL(buffer.Size(), 100);
+        for (int i = 0; i != 100; ++i) {
+            ASSERT_EQUAL(buffer.Front(), std::to_string(i));
+            buffer.PopFront();
+        }
+
+        ASSERT(buffer.Empty(), "buffer should be empty");
+    }
 }
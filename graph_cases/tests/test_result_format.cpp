@@ -0,0 +1,111 @@
+#include "result_format/result_format.h"
+#include "test_system/test_system.h"
+#include "utils.h"
+
+#include <cstdint>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+UNIT_TEST_SUITE(ResultFormat) {
+    NResultFormat::THeader MakeHeader() {
+        NResultFormat::THeader header;
+        header.Source = {4, 3, 1};
+        header.Target = {3, 3, 2};
+        header.DeletedEdges = 2;
+        header.Checkers = {"I3", "I4", "PT"};
+        header.WriteEdgeSet = true;
+        return header;
+    }
+
+    UNIT_TEST(Varint) {
+        TOutputBuffer buffer;
+        NResultFormat::AppendVarint(buffer, 0);
+        NResultFormat::AppendVarint(buffer, 127);
+        NResultFormat::AppendVarint(buffer, 128);
+        ASSERT_EQUAL(buffer.Str(), std::string("\x00\x7f\x80\x01", 4));
+    }
+
+    UNIT_TEST(RoundTrip) {
+        auto header = MakeHeader();
+        std::vector<uint64_t> values = {0, 300, std::numeric_limits<uint64_t>::max()};
+
+        TOutputBuffer buffer;
+        NResultFormat::WriteHeader(buffer, header);
+        NResultFormat::WriteRecord(buffer, 12345, NResultFormat::Match, values.data(), values.size());
+        NResultFormat::WriteRecord(buffer, 0, 2, values.data(), 2);
+
+        std::stringstream in(buffer.Take());
+        NResultFormat::TReader reader(in);
+        AssertVectors(reader.Header().Source, header.Source);
+        AssertVectors(reader.Header().Target, header.Target);
+        AssertVectors(reader.Header().Checkers, header.Checkers);
+        ASSERT_EQUAL(reader.Header().DeletedEdges, 2);
+        ASSERT(reader.Header().WriteEdgeSet, "flag should be kept");
+        ASSERT(!reader.Header().ComputeAll, "flag should be kept");
+
+        NResultFormat::TRecord record;
+        ASSERT(reader.Next(record), "first record");
+        ASSERT_EQUAL(record.Rank, 12345);
+        ASSERT_EQUAL(record.Verdict, NResultFormat::Match);
+        AssertVectors(record.Values, values);
+
+        ASSERT(reader.Next(record), "second record");
+        ASSERT_EQUAL(record.Rank, 0);
+        ASSERT_EQUAL(record.Verdict, 2);
+        AssertVectors(record.Values, std::vector<uint64_t>{0, 300});
+
+        ASSERT(!reader.Next(record), "no more records");
+    }
+
+    UNIT_TEST(Malformed) {
+        bool thrown = false;
+        try {
+            std::stringstream in("not results");
+            NResultFormat::TReader reader(in);
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        ASSERT(thrown, "bad magic should be rejected");
+
+        TOutputBuffer buffer;
+        NResultFormat::WriteHeader(buffer, MakeHeader());
+        NResultFormat::AppendVarint(buffer, 1);
+        std::stringstream in(buffer.Take());
+        NResultFormat::TReader reader(in);
+        NResultFormat::TRecord record;
+        thrown = false;
+        try {
+            reader.Next(record);
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        ASSERT(thrown, "truncated record should be rejected");
+    }
+
+    UNIT_TEST(Text) {
+        auto header = MakeHeader();
+        NMultipartiteGraphs::TEdgeSet edges;
+        edges.insert(NMultipartiteGraphs::TEdge({0, 0}, {2, 1}));
+        std::vector<uint64_t> values = {5, 7};
+
+        TOutputBuffer buffer;
+        NResultFormat::WriteText(buffer, header, 3, edges, 2, values.data(), values.size());
+        ASSERT_EQUAL(buffer.Str(), "TEdge(TNode(0, 0), TNode(2, 1)) I3: 5 I4: 7 Answer: NO Reason: I4 e12=0, e13=1, e23=0\n");
+    }
+
+    UNIT_TEST(EdgeStat) {
+        NMultipartiteGraphs::TEdgeSet edges;
+        edges.insert(NMultipartiteGraphs::TEdge({0, 0}, {2, 1}));
+        edges.insert(NMultipartiteGraphs::TEdge({2, 0}, {0, 1}));
+        edges.insert(NMultipartiteGraphs::TEdge({1, 0}, {2, 1}));
+        auto edgeStat = NResultFormat::ComputeEdgeStat(3, edges);
+        AssertVectors(edgeStat, std::vector<uint64_t>{0, 2, 1});
+
+        TOutputBuffer buffer;
+        NResultFormat::WriteEdgeStat(3, edgeStat, buffer);
+        ASSERT_EQUAL(buffer.Str(), "e12=0, e13=2, e23=1");
+    }
+}
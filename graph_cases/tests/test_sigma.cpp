@@ -1,3 +1,5 @@
+#include "utils.h"
+
 #include "test_system/test_system.h"
 
 #include "math_utils/sigma.h"
@@ -28,4 +30,26 @@ UNIT_TEST_SUITE(Sigma) {
         ASSERT(Sigma(3, v) == 225, "sigma3 mismatched");
         ASSERT(Sigma(4, v) == 274, "sigma4 mismatched");
     }
-}
\ No newline at end of file
+}
+
+UNIT_TEST_SUITE(ElementarySymmetricPolynomials) {
+    UNIT_TEST(Simple) {
+        std::vector<int> v = {1, 2, 3, 4, 5};
+        AssertVectors({1, 15, 85, 225, 274, 120}, ElementarySymmetricPolynomials(5, v));
+    }
+
+    UNIT_TEST(Prefix) {
+        std::vector<int> v = {1, 2, 3, 4, 5};
+        AssertVectors({1, 15, 85}, ElementarySymmetricPolynomials(2, v.begin(), v.end()));
+    }
+
+    UNIT_TEST(DegreeGreaterThanSize) {
+        std::vector<unsigned> v = {3, 3};
+        AssertVectors({1, 6, 9, 0}, ElementarySymmetricPolynomials(3, v));
+    }
+
+    UNIT_TEST(Empty) {
+        std::vector<int> v;
+        AssertVectors({1, 0}, ElementarySymmetricPolynomials(1, v));
+    }
+}
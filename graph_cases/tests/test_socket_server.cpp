@@ -0,0 +1,113 @@
+#include "socket_server/fd_stream.h"
+#include "socket_server/unix_socket_server.h"
+#include "test_system/test_system.h"
+
+#include <chrono>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+UNIT_TEST_SUITE(UnixSocketServer) {
+    std::string Request(const std::string& path, const std::string& request) {
+        int fd = ConnectUnixSocket(path);
+        std::string response;
+        {
+            TFdStreamBuf buffer(fd);
+            std::ostream out(&buffer);
+            out << request << std::flush;
+            ::shutdown(fd, SHUT_WR);
+
+            std::istream in(&buffer);
+            std::getline(in, response, '\0');
+        }
+
+        ::close(fd);
+        return response;
+    }
+
+    UNIT_TEST(Serve) {
+        const std::string path = "test_socket_server.sock";
+        TUnixSocketServer::THandler handler = [](std::istream& in, std::ostream& out) {
+            std::string word;
+            while (in >> word) {
+                if (word == "fail") {
+                    throw std::runtime_error("failed");
+                }
+
+                out << word.size() << '\n';
+            }
+        };
+
+        auto executer = CreateExecuter(2, 0, nullptr);
+        TUnixSocketServer server(path);
+        std::thread serving([&]() {
+            server.Serve(*executer, handler);
+        });
+
+        ASSERT_EQUAL(Request(path, "a bb ccc"), "1\n2\n3\n");
+        ASSERT_EQUAL(Request(path, "dddd fail e"), "4\nerror: failed\n");
+
+        server.Stop();
+        serving.join();
+        executer->Stop();
+    }
+
+    void AnswerLengths(std::istream& in, std::ostream& out) {
+        std::string word;
+        while (in >> word) {
+            out << word.size() << std::endl;
+        }
+    }
+
+    UNIT_TEST(StopWithOpenConnection) {
+        const std::string path = "test_socket_server_stop.sock";
+        TUnixSocketServer::THandler handler = AnswerLengths;
+        auto executer = CreateExecuter(2, 0, nullptr);
+        TUnixSocketServer server(path);
+        std::thread serving([&]() {
+            server.Serve(*executer, handler);
+        });
+
+        // the client keeps its connection open across Stop()
+        int fd = ConnectUnixSocket(path);
+        TFdStreamBuf buffer(fd);
+        std::ostream out(&buffer);
+        std::istream in(&buffer);
+        out << "abc " << std::flush;
+        std::string answer;
+        ASSERT(static_cast<bool>(std::getline(in, answer)), "no answer");
+        ASSERT_EQUAL(answer, "3");
+
+        server.Stop();
+        serving.join();
+        executer->Stop();
+        ASSERT(!std::getline(in, answer), "connection is not closed");
+        ::close(fd);
+    }
+
+    UNIT_TEST(IdleTimeout) {
+        const std::string path = "test_socket_server_idle.sock";
+        TUnixSocketServer::THandler handler = AnswerLengths;
+        auto executer = CreateExecuter(2, 0, nullptr);
+        TUnixSocketServer server(path, 64, std::chrono::milliseconds(50));
+        std::thread serving([&]() {
+            server.Serve(*executer, handler);
+        });
+
+        // idle clients occupy every worker until they time out
+        int first = ConnectUnixSocket(path);
+        int second = ConnectUnixSocket(path);
+        ASSERT_EQUAL(Request(path, "a bb"), "1\n2\n");
+
+        server.Stop();
+        serving.join();
+        executer->Stop();
+        ::close(first);
+        ::close(second);
+    }
+}
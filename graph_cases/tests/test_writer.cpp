@@ -1,16 +1,27 @@
+#include <multithread_writer/mapped_writer.h>
+#include <multithread_writer/output_buffer.h>
+#include <multithread_writer/reorder_buffer.h>
 #include <multithread_writer/writer.h>
 #include <executer/executer.h>
 
 #include <test_system/test_system.h>
 
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
 #include <sstream>
 #include <string>
 #include <unordered_set>
+#include <vector>
 
 UNIT_TEST_SUITE(Writer) {
+    template<typename TWriterType>
     class TPushTask : public ITask {
     public:
-        explicit TPushTask(TWriter& writer, std::string&& s)
+        explicit TPushTask(TWriterType& writer, std::string&& s)
             : Writer(writer)
             , S(s)
         {
@@ -21,19 +32,20 @@ UNIT_TEST_SUITE(Writer) {
         }
 
     private:
-        TWriter& Writer;
+        TWriterType& Writer;
         std::string S;
     };
 
-    UNIT_TEST(Simple) {
+    template<typename TWriterType>
+    void CheckWriter() {
         std::stringstream ss{};
         std::unordered_set<size_t> numbers;
         {
-            auto writer = TWriter{ss};
+            TWriterType writer{ss};
             {
                 auto executer = CreateExecuter(10, 1000, nullptr);
                 for (size_t i = 0; i != 10000; ++i) {
-                    executer->Add(std::make_unique<TPushTask>(writer, std::to_string(i) + " "));
+                    executer->Add(std::make_unique<TPushTask<TWriterType>>(writer, std::to_string(i) + " "));
                     numbers.insert(i);
                 }
             }
@@ -51,5 +63,154 @@ UNIT_TEST_SUITE(Writer) {
 
         ASSERT(numbers.empty(), "all numbers should be read");
     }
+
+    UNIT_TEST(Simple) {
+        CheckWriter<TWriter>();
+    }
+
+    UNIT_TEST(LockFree) {
+        CheckWriter<TLockFreeWriter>();
+    }
+
+    template<typename TWriterType>
+    void CheckLanes(size_t blockSize) {
+        std::stringstream ss{};
+        std::unordered_set<size_t> numbers;
+        {
+            auto executer = CreateExecuter(4, 1000, nullptr);
+            TWriterType writer{ss, executer.get(), blockSize};
+            for (size_t i = 0; i != 10000; ++i) {
+                executer->Add(CreateTask([&writer, i]() {
+                    auto& lane = writer.Lane();
+                    lane << i << ' ';
+                    writer.Commit(lane);
+                }));
+                numbers.insert(i);
+            }
+
+            executer->Stop();
+        }
+
+        size_t number = 0;
+        while (ss >> number) {
+            ASSERT(numbers.erase(number) == 1, "does not expect " << number);
+        }
+
+        ASSERT(numbers.empty(), "all numbers should be read");
+    }
+
+    UNIT_TEST(Lanes) {
+        CheckLanes<TWriter>(TWriter::DefaultBlockSize);
+        CheckLanes<TWriter>(16);
+        CheckLanes<TLockFreeWriter>(1);
+    }
+}
+
+UNIT_TEST_SUITE(OutputBuffer) {
+    UNIT_TEST(Format) {
+        TOutputBuffer buffer;
+        ASSERT(buffer.Empty(), "new buffer should be empty");
+        buffer << "I4: " << 42u << ' ' << std::string("x") << -7 << ' ' << std::numeric_limits<uint64_t>::max();
+        ASSERT_EQUAL(buffer.Str(), "I4: 42 x-7 18446744073709551615");
+
+        auto content = buffer.Take();
+        ASSERT_EQUAL(content, "I4: 42 x-7 18446744073709551615");
+        ASSERT(buffer.Empty(), "buffer should be empty after Take");
+    }
 }
 
+UNIT_TEST_SUITE(ReorderBuffer) {
+    struct TSink {
+        std::vector<std::string> Blocks;
+
+        void Push(std::string&& block) {
+            Blocks.push_back(std::move(block));
+        }
+    };
+
+    UNIT_TEST(Ordered) {
+        for (size_t window : {1, 3, 64}) {
+            TSink sink;
+            TReorderBuffer<TSink> reorder(sink, window);
+            {
+                auto executer = CreateExecuter(4, 0, nullptr);
+                for (uint64_t sequence = 0; sequence != 1000; ++sequence) {
+                    reorder.WaitForSlot(sequence);
+                    executer->Add(CreateTask([&reorder, sequence]() {
+                        reorder.Push(sequence, std::to_string(sequence));
+                    }));
+                }
+            }
+
+            reorder.Finish();
+            ASSERT_EQUAL(sink.Blocks.size(), 1000);
+            for (size_t i = 0; i != sink.Blocks.size(); ++i) {
+                ASSERT_EQUAL(sink.Blocks[i], std::to_string(i));
+            }
+        }
+    }
+
+    UNIT_TEST(FinishSkipsGaps) {
+        TSink sink;
+        TReorderBuffer<TSink> reorder(sink, 4);
+        reorder.Push(2, "2");
+        reorder.Push(1, "1");
+        ASSERT(sink.Blocks.empty(), "block 0 is missing");
+        ASSERT(reorder.HasSlot(3), "window is not full");
+        ASSERT(!reorder.HasSlot(4), "window is full");
+
+        TCancellationToken token;
+        token.Cancel();
+        ASSERT(!reorder.WaitForSlot(4, &token), "cancelled wait should fail");
+
+        reorder.Finish();
+        ASSERT_EQUAL(sink.Blocks.size(), 2);
+        ASSERT_EQUAL(sink.Blocks[0], "1");
+        ASSERT_EQUAL(sink.Blocks[1], "2");
+    }
+}
+
+UNIT_TEST_SUITE(MappedRecordWriter) {
+    UNIT_TEST(Records) {
+        const std::string path = "test_mapped_writer.bin";
+        const std::string header = "header";
+        constexpr size_t RecordSize = 12;
+        constexpr size_t Count = 5000;
+        {
+            // two records per extent, so the extents span several chunks, and a header offset
+            TMappedRecordWriter writer(path, header, RecordSize, 2 * RecordSize);
+            auto executer = CreateExecuter(4, 0, nullptr);
+            for (size_t i = 0; i != Count; ++i) {
+                executer->Add(CreateTask([&writer, i]() {
+                    char* slot = writer.Claim();
+                    std::memset(slot, 'a' + i % 26, RecordSize - sizeof(uint32_t));
+                    uint32_t value = static_cast<uint32_t>(i);
+                    std::memcpy(slot + RecordSize - sizeof(value), &value, sizeof(value));
+                }));
+
+                // checkpoints run while workers map new extents
+                if (i % 500 == 0) {
+                    writer.Sync();
+                }
+            }
+            executer->Stop();
+            writer.Sync();
+            ASSERT_EQUAL(writer.Claimed(), Count);
+        }
+
+        std::ifstream in(path, std::ios::binary);
+        std::string content{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+        std::remove(path.c_str());
+
+        ASSERT_EQUAL(content.size(), header.size() + Count * RecordSize);
+        ASSERT_EQUAL(content.substr(0, header.size()), header);
+        std::vector<bool> seen(Count, false);
+        for (size_t offset = header.size(); offset != content.size(); offset += RecordSize) {
+            uint32_t value;
+            std::memcpy(&value, content.data() + offset + RecordSize - sizeof(value), sizeof(value));
+            ASSERT(value < Count && !seen[value], "record " << value << " is broken or duplicated");
+            seen[value] = true;
+            ASSERT_EQUAL(content[offset], static_cast<char>('a' + value % 26));
+        }
+    }
+}